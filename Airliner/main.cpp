@@ -1,34 +1,74 @@
 //  Created by omar on 11/19/22.
 
 #include <map>
+#include <string>
 #include <vector>
 #include <iostream>
 #include "../Routes/routes.h"
 #include "../Airports/airports.h"
 #include "../ReadWrite/read_write.h"
+#include "../Network/network.h"
+#include "../Matrix/distance_matrix.h"
+#include "../Server/query_server.h"
 
 
 /**
  * @brief The entry point of the program.
+ * Plans the flight in ReadWrite/myfile.txt, or with "--batch <queries> [output]" every query of a batch file, or with
+ * "--matrix <output>" precomputes the hops and distance between every pair of airports, or with
+ * "--serve [socket [delta]]" keeps the network loaded and answers queries on a Unix domain socket, or on standard input
+ * if no socket is given; a server on a socket reloads the data files on a hangup signal and applies the route delta
+ * file on a user signal 1. "--check-delta <delta> <routes>" checks that applying a route delta file gives the same
+ * network as loading the edited route file.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
  * @return int The exit status of the program.
  */
-int main(){
+int main(int argc, char *argv[]){
     
     std::string airport_filename = "//Users/admin/Library/CloudStorage/OneDrive-AshesiUniversity/Ashesi University/ashesi year 2/sem2/intermediate computer programming/AeroNav/Airports/airports.csv";
     
     std::string airRoute_filename = "//Users/admin/Library/CloudStorage/OneDrive-AshesiUniversity/Ashesi University/ashesi year 2/sem2/intermediate computer programming/AeroNav/Routes/routes.csv";
     
-    std::map<std::vector<std::string>, Airport> airport_map;
-    airport_map = Airport::AirportFileReader(airport_filename);
-    // Airport::printMap(airport_map);
+    std::string snapshot_filename = "//Users/admin/Library/CloudStorage/OneDrive-AshesiUniversity/Ashesi University/ashesi year 2/sem2/intermediate computer programming/AeroNav/network.snapshot";
     
-    std::map<std::string, std::vector<std::string>> airport_routemap;
-    airport_routemap = Route::AirportRouteReader(airRoute_filename);
-    // Route::printMap(airport_map);
+    // replies to queries on standard input go to standard output, so progress messages move out of their way
+    if (argc == 2 && std::string(argv[1]) == "--serve")
+    {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
     
-    std::map<std::vector<std::string>, std::vector<std::string>> airline_routemap;
-    airline_routemap = Route::AirlineRouteReader(airRoute_filename);
-    // Route::printMap(airport_map);
+    // loads from the snapshot if it is current, otherwise from the data files, and publishes the network to queries
+    if (!Network::load(snapshot_filename, airport_filename, airRoute_filename))
+    {
+        std::cout << "error loading network: check that the airport and route files are in the right directory" << std::endl;
+        return 1;
+    }
+    // Airport::printMap(Airport::AirportMap);
+    // Route::printMap(Route::AirportRoutesMap);
+    // Route::printMap(Route::AirlineRoutesMap);
+    
+    if (argc >= 3 && std::string(argv[1]) == "--batch")
+    {
+        std::string output_filename = argc >= 4 ? argv[3] : "batch_flight_plans.txt";
+        return ReadWrite::batchFileReader(argv[2], output_filename) > 0 ? 0 : 1;
+    }
+    
+    if (argc >= 3 && std::string(argv[1]) == "--matrix")
+    {
+        return DistanceMatrix::compute(Network::current()->graph(), argv[2]) ? 0 : 1;
+    }
+    
+    if (argc >= 4 && std::string(argv[1]) == "--check-delta")
+    {
+        return Network::checkDelta(argv[2], argv[3]) ? 0 : 1;
+    }
+    
+    if (argc >= 2 && std::string(argv[1]) == "--serve")
+    {
+        bool served = argc >= 3 ? QueryServer::serveSocket(argv[2], 0, argc >= 4 ? argv[3] : "") : QueryServer::serveStream();
+        return served ? 0 : 1;
+    }
     
     ReadWrite::inputFileReader("//Users/admin/Library/CloudStorage/OneDrive-AshesiUniversity/Ashesi University/ashesi year 2/sem2/intermediate computer programming/AeroNav/ReadWrite/myfile.txt");
     
@@ -1,25 +1,30 @@
 // Created by Omar Basheer on 11/19/22.
 
 #include <map>
+#include <cmath>
 #include <string>
 #include <vector>
-#include <fstream>
+#include <cstdint>
 #include <sstream>
 #include <iostream>
+#include <string_view>
+#include <unordered_map>
 #include "airports.h"
+#include "../Csv/csv_reader.h"
+#include "../Mmap/mapped_file.h"
 
 /**
  * @brief Default constructor for the Airport class.
- * Initializes all member variables to empty strings.
+ * Initializes all text members to empty strings and the coordinates to NaN.
  */
 Airport::Airport()
 {
     this->AirportName = "";
     this->AirportCity = "";
     this->Country = "";
-    this->IATA_Code = "";
-    this->Latitude = "";
-    this->Longitude = "";
+    this->IATA_Code = IataCode();
+    this->Latitude = NAN;
+    this->Longitude = NAN;
 }
 
 /**
@@ -29,10 +34,10 @@ Airport::Airport()
  * @param airportCity The city where the airport is located.
  * @param country The country where the airport is located.
  * @param iataCode The IATA code of the airport.
- * @param latitude The latitude coordinate of the airport.
- * @param longitude The longitude coordinate of the airport.
+ * @param latitude The latitude of the airport in degrees, or NaN if unknown.
+ * @param longitude The longitude of the airport in degrees, or NaN if unknown.
  */
-Airport::Airport(std::string airportName, std::string airportCity, std::string country, std::string iataCode, std::string latitude, std::string longitude)
+Airport::Airport(std::string airportName, std::string airportCity, std::string country, IataCode iataCode, double latitude, double longitude)
 {
     this->AirportName = airportName;
     this->AirportCity = airportCity;
@@ -76,9 +81,9 @@ const std::string Airport::getCountry() const
 /**
  * @brief Get the IATA code of the airport.
  *
- * @return The IATA code as a string.
+ * @return The IATA code.
  */
-const std::string Airport::getIataCode() const
+IataCode Airport::getIataCode() const
 {
     return IATA_Code;
 }
@@ -86,9 +91,9 @@ const std::string Airport::getIataCode() const
 /**
  * @brief Gets the latitude of the airport.
  *
- * @return The latitude of the airport as a string.
+ * @return The latitude of the airport in degrees, or NaN if unknown.
  */
-const std::string Airport::getLatitude() const
+double Airport::getLatitude() const
 {
     return Latitude;
 }
@@ -96,13 +101,23 @@ const std::string Airport::getLatitude() const
 /**
  * @brief Get the longitude of the airport.
  *
- * @return The longitude of the airport as a string.
+ * @return The longitude of the airport in degrees, or NaN if unknown.
  */
-const std::string Airport::getLongitude() const
+double Airport::getLongitude() const
 {
     return Longitude;
 }
 
+/**
+ * @brief Checks whether the airport has usable coordinates.
+ *
+ * @return True if both coordinates are known, false otherwise.
+ */
+bool Airport::hasCoordinates() const
+{
+    return !std::isnan(Latitude) && !std::isnan(Longitude);
+}
+
 /**
  * @brief Converts the airport information to a string representation.
  *
@@ -110,7 +125,10 @@ const std::string Airport::getLongitude() const
  */
 const std::string Airport::toString() const
 {
-    return "Airport - [" + getAirportName() + ", " + getAirportCity() + ", " + getCountry() + ", " + getIataCode() + ", " + getLatitude() + ", " + getLongitude() + "]";
+    std::stringstream stream;
+    stream.precision(10);
+    stream << "Airport - [" << getAirportName() << ", " << getAirportCity() << ", " << getCountry() << ", " << getIataCode().toString() << ", " << getLatitude() << ", " << getLongitude() << "]";
+    return stream.str();
 }
 
 /**
@@ -137,12 +155,31 @@ std::string Airport::vecToString(const std::vector<std::string> string_vector)
 }
 
 /**
- * @brief A map that associates a vector of strings with an Airport object.
- * 
- * The keys of the map are vectors of strings, and the values are Airport objects.
- * This map allows efficient lookup of an Airport based on a vector of strings.
+ * @brief A map that associates an IATA code with an Airport object.
+ *
+ * This map allows efficient lookup of an Airport based on its IATA code.
+ */
+std::map<IataCode, Airport> Airport::AirportMap;
+
+/**
+ * @brief The table numbering every known airport with a dense id.
  */
-std::map<std::vector<std::string>, Airport> Airport::AirportMap;
+IataTable Airport::AirportIds;
+
+/**
+ * @brief An index from normalized (city, country) keys to the ids of the airports in that city.
+ */
+std::unordered_map<std::string, std::vector<std::uint32_t>> Airport::CityIndex;
+
+/**
+ * @brief The airport record of every airport id, pointing into AirportMap.
+ */
+std::vector<const Airport *> Airport::AirportsById;
+
+/**
+ * @brief A spatial index over the coordinates of every airport of AirportMap that has them.
+ */
+AirportTree Airport::LocationIndex;
 
 /**
  * @brief Reads airport data from a file and creates a map of airports.
@@ -154,53 +191,44 @@ std::map<std::vector<std::string>, Airport> Airport::AirportMap;
  * 5. IATA code
  * 6. Latitude
  * 7. Longitude
+ * Airports without a valid IATA code are skipped. Every airport read is interned in AirportIds, in file order.
  *
  * @param filename The name of the file to read the airport data from.
- * @return A map of airports, where the key is a vector of strings containing the IATA code, city, and country,
+ * @return A map of airports, where the key is the IATA code of the airport
  *         and the value is an Airport object containing the airport details.
  */
-std::map<std::vector<std::string>, Airport> Airport::AirportFileReader(const std::string &filename)
+std::map<IataCode, Airport> Airport::AirportFileReader(const std::string &filename)
 {
-    std::fstream inputStream;
-    inputStream.open(filename);
+    MappedFile file;
 
-    if (inputStream)
+    if (file.open(filename))
     {
-        // cout << "> file opened" << endl;
-        std::vector<std::string> splitline;
-        std::string streamline, streamword, temp;
+        // only the columns up to longitude are split; quoted names may contain commas
+        CsvReader reader(file.data(), file.data() + file.size());
+        std::string_view streamline;
+        std::string_view splitline[8];
 
-        while (getline(inputStream, streamline))
+        while (reader.nextRow(streamline))
         {
-
-            splitline.clear();
-            std::stringstream line_of(streamline);
-            // cout << "  >> got streamline" << endl;
-            // cout << "   >> streamline: " << streamline << endl;
-
-            while (getline(line_of, streamword, ','))
+            if (CsvReader::splitFields(streamline, splitline, 8) < 8)
             {
-                splitline.push_back(streamword);
-                // cout << "   >> got streamword: " << streamword << endl;
+                continue;
             }
 
-            if (!(splitline[4] == "\\N"))
+            IataCode airportKey = IataCode::fromChars(splitline[4].data(), splitline[4].size());
+            if (airportKey.isValid())
             {
-                std::vector<std::string> airportKey;
-                airportKey.emplace_back(splitline[4]);
-                airportKey.emplace_back(splitline[2]);
-                airportKey.emplace_back(splitline[3]);
-                // std::cout << vecToString(airportKey);
-
-                Airport airport = Airport(splitline[1], splitline[2], splitline[3], splitline[4],
-                                          splitline[6], splitline[7]);
+                Airport airport = Airport(CsvReader::unquote(splitline[1]), CsvReader::unquote(splitline[2]), CsvReader::unquote(splitline[3]),
+                                          airportKey, CsvReader::toDouble(splitline[6]), CsvReader::toDouble(splitline[7]));
                 // std::cout << airport.toString() << std::endl;
                 // std::cout << std::endl;
-                AirportMap.insert(std::pair<std::vector<std::string>, Airport>(airportKey, airport));
+                AirportMap.insert(std::pair<IataCode, Airport>(airportKey, airport));
+                AirportIds.intern(airportKey);
             }
         }
-        inputStream.close();
         std::cout << "> Airports map created..." << std::endl;
+        buildCityIndex();
+        buildLocationIndex();
     }
 
     else
@@ -211,16 +239,87 @@ std::map<std::vector<std::string>, Airport> Airport::AirportFileReader(const std
     return AirportMap;
 }
 
+/**
+ * @brief Builds the normalized index key of a city.
+ * Letters are lowercased, leading and trailing whitespace is dropped and inner runs of whitespace become one space,
+ * so "New York, United States" and " new  york, UNITED STATES" give the same key.
+ *
+ * @param city The name of the city.
+ * @param country The name of the country the city is in.
+ * @return The key of the city in CityIndex.
+ */
+std::string Airport::cityKey(const std::string &city, const std::string &country)
+{
+    std::string key;
+    key.reserve(city.size() + country.size() + 1);
+    auto append = [&key](const std::string &name)
+    {
+        bool pendingSpace = false;
+        std::size_t begin = key.size();
+        for (char c : name)
+        {
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            {
+                pendingSpace = key.size() > begin;
+                continue;
+            }
+            if (pendingSpace)
+            {
+                key.push_back(' ');
+                pendingSpace = false;
+            }
+            key.push_back(c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c);
+        }
+    };
+    append(city);
+    // a separator that cannot appear in a name keeps ("a b", "c") and ("a", "b c") apart
+    key.push_back('\x1f');
+    append(country);
+    return key;
+}
+
+/**
+ * @brief Rebuilds CityIndex and AirportsById from AirportMap.
+ */
+void Airport::buildCityIndex()
+{
+    CityIndex.clear();
+    AirportsById.assign(AirportIds.size(), nullptr);
+    for (auto const &pair : AirportMap)
+    {
+        std::uint32_t id = AirportIds.find(pair.first);
+        CityIndex[cityKey(pair.second.getAirportCity(), pair.second.getCountry())].push_back(id);
+        AirportsById[id] = &pair.second;
+    }
+}
+
+/**
+ * @brief Rebuilds LocationIndex from AirportMap.
+ */
+void Airport::buildLocationIndex()
+{
+    std::vector<std::uint32_t> ids;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    for (auto const &pair : AirportMap)
+    {
+        ids.push_back(AirportIds.find(pair.first));
+        latitudes.push_back(pair.second.getLatitude());
+        longitudes.push_back(pair.second.getLongitude());
+    }
+    LocationIndex = AirportTree::build(ids, latitudes, longitudes);
+}
+
 /**
  * @brief Prints the contents of a map of airports.
  *
  * @param thisMap The map of airports to be printed.
  */
-void Airport::printMap(const std::map<std::vector<std::string>, Airport> thisMap)
+void Airport::printMap(const std::map<IataCode, Airport> &thisMap)
 {
     for (auto const &pair : thisMap)
     {
-        std::cout << vecToString(pair.first) << " >> " << pair.second.toString() << std::endl;
+        std::cout << "[" << pair.first.toString() << "] >> " << pair.second.toString() << std::endl;
     }
 }
 
@@ -6,6 +6,10 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include "../Iata/iata.h"
+#include "../Spatial/airport_tree.h"
 
 /**
  * @class Airport
@@ -20,14 +24,14 @@ private:
     std::string AirportName;
     std::string AirportCity;
     std::string Country;
-    std::string IATA_Code;
-    std::string Latitude;
-    std::string Longitude;
+    IataCode IATA_Code;
+    double Latitude;
+    double Longitude;
 
 public:
     /**
      * @brief Default constructor for the Airport class.
-     * Initializes all member variables to empty strings.
+     * Initializes all text members to empty strings and the coordinates to NaN.
      */
     Airport();
 
@@ -38,10 +42,10 @@ public:
      * @param airportCity The city where the airport is located.
      * @param country The country where the airport is located.
      * @param iataCode The IATA code of the airport.
-     * @param latitude The latitude coordinate of the airport.
-     * @param longitude The longitude coordinate of the airport.
+     * @param latitude The latitude of the airport in degrees, or NaN if unknown.
+     * @param longitude The longitude of the airport in degrees, or NaN if unknown.
      */
-    Airport(std::string airportName, std::string airportCity, std::string country, std::string iataCode, std::string latitude, std::string longitude);
+    Airport(std::string airportName, std::string airportCity, std::string country, IataCode iataCode, double latitude, double longitude);
 
     /**
      * @brief Get the name of the airport.
@@ -67,23 +71,30 @@ public:
     /**
      * @brief Get the IATA code of the airport.
      *
-     * @return The IATA code as a string.
+     * @return The IATA code.
      */
-    const std::string getIataCode() const;
+    IataCode getIataCode() const;
 
     /**
      * @brief Gets the latitude of the airport.
      *
-     * @return The latitude of the airport as a string.
+     * @return The latitude of the airport in degrees, or NaN if unknown.
      */
-    const std::string getLatitude() const;
+    double getLatitude() const;
 
     /**
      * @brief Get the longitude of the airport.
      *
-     * @return The longitude of the airport as a string.
+     * @return The longitude of the airport in degrees, or NaN if unknown.
      */
-    const std::string getLongitude() const;
+    double getLongitude() const;
+
+    /**
+     * @brief Checks whether the airport has usable coordinates.
+     *
+     * @return True if both coordinates are known, false otherwise.
+     */
+    bool hasCoordinates() const;
 
     /**
      * @brief Converts the airport information to a string representation.
@@ -111,27 +122,78 @@ public:
      * 6. Latitude
      * 7. Longitude
      *
+     * Airports without a valid IATA code are skipped. Every airport read is interned in AirportIds, in file order.
+     *
      * @param filename The name of the file to read the airport data from.
-     * @return A map of airports, where the key is a vector of strings containing the IATA code, city, and country,
+     * @return A map of airports, where the key is the IATA code of the airport
      *         and the value is an Airport object containing the airport details.
      */
-    static std::map<std::vector<std::string>, Airport> AirportFileReader(const std::string &filename);
+    static std::map<IataCode, Airport> AirportFileReader(const std::string &filename);
+
+
+    /**
+     * @brief A map that associates an IATA code with an Airport object.
+     *
+     * This map allows efficient lookup of an Airport based on its IATA code.
+     */
+    static std::map<IataCode, Airport> AirportMap;
+
+    /**
+     * @brief The table numbering every known airport with a dense id.
+     *
+     * Airports from the airport file are numbered first; airports that only appear in route data are
+     * added when the routes are read. Per-airport arrays, such as the route graph, are indexed by these ids.
+     */
+    static IataTable AirportIds;
+
+    /**
+     * @brief An index from normalized (city, country) keys to the ids of the airports in that city.
+     *
+     * Built from AirportMap whenever the airports are loaded; the ids of each city are in IATA code order.
+     */
+    static std::unordered_map<std::string, std::vector<std::uint32_t>> CityIndex;
 
+    /**
+     * @brief The airport record of every airport id, pointing into AirportMap.
+     *
+     * Airports that only appear in route data have no record and a null entry. Built together with CityIndex;
+     * queries read the copy in Network::findAirport.
+     */
+    static std::vector<const Airport *> AirportsById;
 
     /**
-     * @brief A map that associates a vector of strings with an Airport object.
+     * @brief A spatial index over the coordinates of every airport of AirportMap that has them.
+     * Queries read the copy in Network::nearest and Network::within.
+     */
+    static AirportTree LocationIndex;
+
+    /**
+     * @brief Builds the normalized index key of a city.
+     * Letters are lowercased, leading and trailing whitespace is dropped and inner runs of whitespace become one space,
+     * so "New York, United States" and " new  york, UNITED STATES" give the same key.
      *
-     * The keys of the map are vectors of strings, and the values are Airport objects.
-     * This map allows efficient lookup of an Airport based on a vector of strings.
+     * @param city The name of the city.
+     * @param country The name of the country the city is in.
+     * @return The key of the city in CityIndex.
+     */
+    static std::string cityKey(const std::string &city, const std::string &country);
+
+    /**
+     * @brief Rebuilds CityIndex and AirportsById from AirportMap.
+     */
+    static void buildCityIndex();
+
+    /**
+     * @brief Rebuilds LocationIndex from AirportMap.
      */
-    static std::map<std::vector<std::string>, Airport> AirportMap;
+    static void buildLocationIndex();
 
     /**
      * @brief Prints the contents of a map of airports.
      *
      * @param thisMap The map of airports to be printed.
      */
-    static void printMap(const std::map<std::vector<std::string>, Airport> thisMap);
+    static void printMap(const std::map<IataCode, Airport> &thisMap);
 };
 
 #endif // AIRPORT_H
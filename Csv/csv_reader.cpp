@@ -0,0 +1,188 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+#include "csv_reader.h"
+
+/**
+ * @brief Constructs a reader over a buffer.
+ *
+ * @param begin The first byte of the buffer.
+ * @param end One past the last byte of the buffer.
+ */
+CsvReader::CsvReader(const char *begin, const char *end)
+{
+    this->Cursor = begin;
+    this->End = end;
+}
+
+/**
+ * @brief Reads the next row of the buffer.
+ *
+ * @param row Set to the next row, without its line terminator.
+ * @return True if a row was read, false if the end of the buffer was reached.
+ */
+bool CsvReader::nextRow(std::string_view &row)
+{
+    if (Cursor == nullptr || Cursor >= End)
+    {
+        return false;
+    }
+
+    const char *newline = static_cast<const char *>(memchr(Cursor, '\n', static_cast<std::size_t>(End - Cursor)));
+    const char *rowEnd = newline != nullptr ? newline : End;
+    row = std::string_view(Cursor, static_cast<std::size_t>(rowEnd - Cursor));
+    if (!row.empty() && row.back() == '\r')
+    {
+        row.remove_suffix(1);
+    }
+
+    Cursor = newline != nullptr ? newline + 1 : End;
+    return true;
+}
+
+/**
+ * @brief Splits a buffer into chunks that each hold whole rows.
+ *
+ * Chunk boundaries are moved forward to the start of the next row, so every row belongs to exactly one
+ * chunk and the chunks, read in order, hold the rows of the buffer in order. Fewer chunks than asked for
+ * are returned when the buffer has too few rows.
+ *
+ * @param begin The first byte of the buffer.
+ * @param end One past the last byte of the buffer.
+ * @param count The number of chunks wanted.
+ * @return The [begin, end) range of every chunk.
+ */
+std::vector<std::pair<const char *, const char *>> CsvReader::splitChunks(const char *begin, const char *end, std::size_t count)
+{
+    std::vector<std::pair<const char *, const char *>> chunks;
+    std::size_t size = static_cast<std::size_t>(end - begin);
+    if (count == 0)
+    {
+        count = 1;
+    }
+
+    const char *chunkBegin = begin;
+    for (std::size_t i = 1; i <= count && chunkBegin < end; i++)
+    {
+        const char *chunkEnd = end;
+        if (i < count)
+        {
+            const char *target = begin + size / count * i;
+            if (target < chunkBegin)
+            {
+                target = chunkBegin;
+            }
+            const char *newline = static_cast<const char *>(memchr(target, '\n', static_cast<std::size_t>(end - target)));
+            chunkEnd = newline != nullptr ? newline + 1 : end;
+        }
+        chunks.emplace_back(chunkBegin, chunkEnd);
+        chunkBegin = chunkEnd;
+    }
+
+    return chunks;
+}
+
+/**
+ * @brief Splits the leading fields of a row.
+ *
+ * Only the first `count` fields are scanned; the rest of the row is never looked at. Quoted fields are
+ * returned without their surrounding quotes but with doubled quotes left in place (see unquote).
+ *
+ * @param row The row to split.
+ * @param fields Receives the fields of the row; must have room for `count` views.
+ * @param count The number of leading fields wanted.
+ * @return The number of fields found, which is less than `count` if the row is short.
+ */
+std::size_t CsvReader::splitFields(std::string_view row, std::string_view *fields, std::size_t count)
+{
+    std::size_t found = 0;
+    std::size_t pos = 0;
+
+    while (found < count && pos <= row.size())
+    {
+        std::size_t next;
+        if (pos < row.size() && row[pos] == '"')
+        {
+            // quoted field: runs to the first quote that is not part of a doubled quote
+            std::size_t close = pos + 1;
+            while (close < row.size() && !(row[close] == '"' && (close + 1 >= row.size() || row[close + 1] != '"')))
+            {
+                close += row[close] == '"' ? 2 : 1;
+            }
+            fields[found++] = row.substr(pos + 1, close - pos - 1);
+            next = row.find(',', close);
+        }
+        else
+        {
+            next = row.find(',', pos);
+            fields[found++] = row.substr(pos, next == std::string_view::npos ? std::string_view::npos : next - pos);
+        }
+
+        if (next == std::string_view::npos)
+        {
+            break;
+        }
+        pos = next + 1;
+    }
+
+    return found;
+}
+
+/**
+ * @brief Copies a field into a string, turning doubled quotes back into single quotes.
+ *
+ * @param field A field returned by splitFields.
+ * @return The text of the field.
+ */
+std::string CsvReader::unquote(std::string_view field)
+{
+    std::string text;
+    text.reserve(field.size());
+    for (std::size_t i = 0; i < field.size(); i++)
+    {
+        text.push_back(field[i]);
+        if (field[i] == '"' && i + 1 < field.size() && field[i + 1] == '"')
+        {
+            i++;
+        }
+    }
+    return text;
+}
+
+/**
+ * @brief Parses a field holding a whole number.
+ *
+ * @param field A field returned by splitFields.
+ * @return The number, or 0 if the field does not start with a number.
+ */
+int CsvReader::toInt(std::string_view field)
+{
+    int value = 0;
+    std::from_chars(field.data(), field.data() + field.size(), value);
+    return value;
+}
+
+/**
+ * @brief Parses a field holding a decimal number, such as a coordinate.
+ *
+ * @param field A field returned by splitFields.
+ * @return The number, or NaN if the field does not start with a number.
+ */
+double CsvReader::toDouble(std::string_view field)
+{
+    // fields are not NUL terminated; numbers are short enough to copy into a small buffer
+    char buffer[64];
+    std::size_t length = std::min(field.size(), sizeof(buffer) - 1);
+    memcpy(buffer, field.data(), length);
+    buffer[length] = '\0';
+    char *end = nullptr;
+    double value = std::strtod(buffer, &end);
+    return end == buffer ? NAN : value;
+}
@@ -0,0 +1,97 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <string_view>
+
+/**
+ * @class CsvReader
+ * @brief A zero-copy reader for comma separated data held in memory, such as a MappedFile.
+ *
+ * Rows and fields are returned as views into the underlying buffer, so nothing is copied unless the caller
+ * keeps a field. Rows end at a newline (a trailing carriage return is dropped). Fields may be wrapped in
+ * double quotes, in which case they can contain commas and doubled quotes ("") stand for a single quote;
+ * quoted fields cannot span several lines.
+ */
+class CsvReader
+{
+
+private:
+    const char *Cursor; /**< The start of the next unread row. */
+    const char *End; /**< One past the last byte of the buffer. */
+
+public:
+    /**
+     * @brief Constructs a reader over a buffer.
+     *
+     * @param begin The first byte of the buffer.
+     * @param end One past the last byte of the buffer.
+     */
+    CsvReader(const char *begin, const char *end);
+
+    /**
+     * @brief Reads the next row of the buffer.
+     *
+     * @param row Set to the next row, without its line terminator.
+     * @return True if a row was read, false if the end of the buffer was reached.
+     */
+    bool nextRow(std::string_view &row);
+
+    /**
+     * @brief Splits a buffer into chunks that each hold whole rows.
+     *
+     * Chunk boundaries are moved forward to the start of the next row, so every row belongs to exactly one
+     * chunk and the chunks, read in order, hold the rows of the buffer in order. Fewer chunks than asked for
+     * are returned when the buffer has too few rows.
+     *
+     * @param begin The first byte of the buffer.
+     * @param end One past the last byte of the buffer.
+     * @param count The number of chunks wanted.
+     * @return The [begin, end) range of every chunk.
+     */
+    static std::vector<std::pair<const char *, const char *>> splitChunks(const char *begin, const char *end, std::size_t count);
+
+    /**
+     * @brief Splits the leading fields of a row.
+     *
+     * Only the first `count` fields are scanned; the rest of the row is never looked at. Quoted fields are
+     * returned without their surrounding quotes but with doubled quotes left in place (see unquote).
+     *
+     * @param row The row to split.
+     * @param fields Receives the fields of the row; must have room for `count` views.
+     * @param count The number of leading fields wanted.
+     * @return The number of fields found, which is less than `count` if the row is short.
+     */
+    static std::size_t splitFields(std::string_view row, std::string_view *fields, std::size_t count);
+
+    /**
+     * @brief Copies a field into a string, turning doubled quotes back into single quotes.
+     *
+     * @param field A field returned by splitFields.
+     * @return The text of the field.
+     */
+    static std::string unquote(std::string_view field);
+
+    /**
+     * @brief Parses a field holding a whole number.
+     *
+     * @param field A field returned by splitFields.
+     * @return The number, or 0 if the field does not start with a number.
+     */
+    static int toInt(std::string_view field);
+
+    /**
+     * @brief Parses a field holding a decimal number, such as a coordinate.
+     *
+     * @param field A field returned by splitFields.
+     * @return The number, or NaN if the field does not start with a number.
+     */
+    static double toDouble(std::string_view field);
+};
+
+#endif // CSV_READER_H
@@ -0,0 +1,322 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include "airline_index.h"
+#include "../ThreadPool/thread_pool.h"
+
+/**
+ * @brief Default constructor for the AirlineIndex class.
+ * Creates an empty index with no routes.
+ */
+AirlineIndex::AirlineIndex()
+{
+    this->Offsets.push_back(0);
+}
+
+/**
+ * @brief The number of airline routes looked up or scattered by one task of the thread pool.
+ */
+static const std::size_t RoutesPerTask = 64 * 1024;
+
+/**
+ * @brief Orders airline entries by route, then by stops, then by airline.
+ *
+ * @param a The first entry.
+ * @param b The second entry.
+ * @return True if a comes before b.
+ */
+static bool entryBefore(const std::pair<std::uint32_t, EdgeAirline> &a, const std::pair<std::uint32_t, EdgeAirline> &b)
+{
+    if (a.first != b.first)
+    {
+        return a.first < b.first;
+    }
+    if (a.second.Stops != b.second.Stops)
+    {
+        return a.second.Stops < b.second.Stops;
+    }
+    return a.second.Airline < b.second.Airline;
+}
+
+/**
+ * @brief Checks whether two airline entries name the same airline on the same route with the same stops.
+ *
+ * @param a The first entry.
+ * @param b The second entry.
+ * @return True if the entries are the same.
+ */
+static bool sameEntry(const std::pair<std::uint32_t, EdgeAirline> &a, const std::pair<std::uint32_t, EdgeAirline> &b)
+{
+    return a.first == b.first && a.second.Stops == b.second.Stops && a.second.Airline == b.second.Airline;
+}
+
+/**
+ * @brief Builds the airline index of a graph.
+ * Rows naming a route the graph does not have are ignored, and an airline listed twice for a route is kept once.
+ *
+ * Every step runs on the thread pool. The routes are looked up in the graph a block per task, then scattered into
+ * one bucket per range of routes, a range per task; as routes are numbered by source airport, each bucket holds the
+ * routes of a range of sources. Each bucket is sorted and deduplicated on its own, and the buckets, laid back to
+ * back, give the same index as one sort over every route.
+ *
+ * @param graph The route graph the index belongs to.
+ * @param routes Every airline route, in any order.
+ * @param threads The number of threads to build with, or 0 to use every hardware thread.
+ * @return The airline index.
+ */
+AirlineIndex AirlineIndex::build(const FlightGraph &graph, const std::vector<AirlineRoute> &routes, unsigned threads)
+{
+    AirlineIndex index;
+    index.Offsets.assign(graph.routeCount() + 1, 0);
+    if (graph.routeCount() == 0)
+    {
+        return index;
+    }
+
+    ThreadPool pool(threads);
+    std::size_t blockCount = (routes.size() + RoutesPerTask - 1) / RoutesPerTask;
+    std::size_t bucketCount = std::max<std::size_t>(1, std::min<std::size_t>(pool.size() * 4, graph.routeCount()));
+    auto bucketOf = [&graph, bucketCount](std::uint32_t edge)
+    {
+        return static_cast<std::size_t>(static_cast<std::uint64_t>(edge) * bucketCount / graph.routeCount());
+    };
+
+    // pair every airline with its route's edge index, counting how many of each block go to each bucket
+    std::vector<std::uint32_t> edges(routes.size());
+    std::vector<std::size_t> counts(blockCount * bucketCount, 0);
+    for (std::size_t block = 0; block < blockCount; block++)
+    {
+        pool.submit([&, block]()
+                    {
+                        std::size_t last = std::min(routes.size(), (block + 1) * RoutesPerTask);
+                        for (std::size_t i = block * RoutesPerTask; i < last; i++)
+                        {
+                            edges[i] = graph.findEdge(routes[i].Source, routes[i].Destination);
+                            if (edges[i] != IataTable::NoId)
+                            {
+                                counts[block * bucketCount + bucketOf(edges[i])]++;
+                            }
+                        } });
+    }
+    pool.wait();
+
+    // every block writes its entries of a bucket to its own slice of the bucket, in route order
+    std::vector<std::size_t> bucketBegin(bucketCount + 1, 0);
+    std::vector<std::size_t> slots(blockCount * bucketCount, 0);
+    std::size_t total = 0;
+    for (std::size_t bucket = 0; bucket < bucketCount; bucket++)
+    {
+        bucketBegin[bucket] = total;
+        for (std::size_t block = 0; block < blockCount; block++)
+        {
+            slots[block * bucketCount + bucket] = total;
+            total += counts[block * bucketCount + bucket];
+        }
+    }
+    bucketBegin[bucketCount] = total;
+    std::vector<std::pair<std::uint32_t, EdgeAirline>> entries(total);
+    for (std::size_t block = 0; block < blockCount; block++)
+    {
+        pool.submit([&, block]()
+                    {
+                        std::size_t last = std::min(routes.size(), (block + 1) * RoutesPerTask);
+                        for (std::size_t i = block * RoutesPerTask; i < last; i++)
+                        {
+                            if (edges[i] != IataTable::NoId)
+                            {
+                                entries[slots[block * bucketCount + bucketOf(edges[i])]++] = std::make_pair(edges[i], routes[i].Operator);
+                            }
+                        } });
+    }
+    pool.wait();
+
+    // sort each bucket so each route's airlines are contiguous, and count them; buckets cover disjoint routes
+    std::vector<std::size_t> bucketSize(bucketCount, 0);
+    for (std::size_t bucket = 0; bucket < bucketCount; bucket++)
+    {
+        pool.submit([&, bucket]()
+                    {
+                        auto first = entries.begin() + bucketBegin[bucket];
+                        auto last = entries.begin() + bucketBegin[bucket + 1];
+                        std::sort(first, last, entryBefore);
+                        last = std::unique(first, last, sameEntry);
+                        bucketSize[bucket] = last - first;
+                        for (auto entry = first; entry != last; entry++)
+                        {
+                            index.Offsets[entry->first + 1]++;
+                        } });
+    }
+    pool.wait();
+
+    std::vector<std::size_t> outputBegin(bucketCount + 1, 0);
+    for (std::size_t bucket = 0; bucket < bucketCount; bucket++)
+    {
+        outputBegin[bucket + 1] = outputBegin[bucket] + bucketSize[bucket];
+    }
+    index.Airlines.resize(outputBegin[bucketCount]);
+    for (std::size_t bucket = 0; bucket < bucketCount; bucket++)
+    {
+        pool.submit([&, bucket]()
+                    {
+                        for (std::size_t i = 0; i < bucketSize[bucket]; i++)
+                        {
+                            index.Airlines[outputBegin[bucket] + i] = entries[bucketBegin[bucket] + i].second;
+                        } });
+    }
+    pool.wait();
+
+    for (std::size_t edge = 0; edge < graph.routeCount(); edge++)
+    {
+        index.Offsets[edge + 1] += index.Offsets[edge];
+    }
+
+    return index;
+}
+
+/**
+ * @brief Builds the airline index of a changed graph from the index of the graph it was changed from.
+ *
+ * Only the routes of the changed graph leaving the same airport as a changed route can differ from the previous
+ * graph, so every other airport's airlines are copied as one block. In the rows that changed, the rows of both
+ * graphs are walked side by side, so every route is matched with the same route of the previous graph without a
+ * search. Changed routes get their airlines from the list, sorted and deduplicated the way build does; the others
+ * copy their run of the previous index. The copy is still a pass over the whole index: every airline is copied and,
+ * since the routes after a changed one move, every offset is written again.
+ *
+ * @param graph The changed graph.
+ * @param previousGraph The graph the previous index belongs to.
+ * @param previous The index of previousGraph.
+ * @param changed The routes whose airlines changed, as (source, destination) ids.
+ * @param routes Every airline of the changed routes, in any order; rows of other routes are ignored.
+ * @return The airline index of the changed graph.
+ */
+AirlineIndex AirlineIndex::update(const FlightGraph &graph, const FlightGraph &previousGraph, const AirlineIndex &previous, std::vector<std::pair<std::uint32_t, std::uint32_t>> changed, std::vector<AirlineRoute> routes)
+{
+    AirlineIndex index;
+
+    // changes sorted by route, and each route's airlines by stops, then airline code
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    auto before = [](const AirlineRoute &a, const AirlineRoute &b)
+    {
+        if (a.Source != b.Source)
+        {
+            return a.Source < b.Source;
+        }
+        if (a.Destination != b.Destination)
+        {
+            return a.Destination < b.Destination;
+        }
+        if (a.Operator.Stops != b.Operator.Stops)
+        {
+            return a.Operator.Stops < b.Operator.Stops;
+        }
+        return a.Operator.Airline < b.Operator.Airline;
+    };
+    auto same = [](const AirlineRoute &a, const AirlineRoute &b)
+    {
+        return a.Source == b.Source && a.Destination == b.Destination && a.Operator.Stops == b.Operator.Stops && a.Operator.Airline == b.Operator.Airline;
+    };
+    std::sort(routes.begin(), routes.end(), before);
+    routes.erase(std::unique(routes.begin(), routes.end(), same), routes.end());
+    auto change = changed.begin();
+    auto route = routes.begin();
+
+    index.Offsets.assign(graph.routeCount() + 1, 0);
+    index.Airlines.reserve(previous.Airlines.size() + routes.size());
+    for (std::uint32_t source = 0; source < graph.airportCount(); source++)
+    {
+        // a row without changed routes is the same in both graphs, so its airlines are copied as one block
+        while (change != changed.end() && change->first < source)
+        {
+            ++change;
+        }
+        if ((change == changed.end() || change->first != source) && source < previousGraph.airportCount() && previous.routeCount() == previousGraph.routeCount())
+        {
+            std::size_t first = static_cast<std::size_t>(graph.successorsBegin(source) - graph.neighbors().data());
+            std::size_t previousFirst = static_cast<std::size_t>(previousGraph.successorsBegin(source) - previousGraph.neighbors().data());
+            std::uint32_t shift = static_cast<std::uint32_t>(index.Airlines.size()) - previous.Offsets[previousFirst];
+            index.Airlines.insert(index.Airlines.end(), previous.airlinesBegin(static_cast<std::uint32_t>(previousFirst)),
+                                  previous.airlinesBegin(static_cast<std::uint32_t>(previousFirst)) + (previous.Offsets[previousFirst + graph.degree(source)] - previous.Offsets[previousFirst]));
+            for (std::size_t k = 1; k <= graph.degree(source); k++)
+            {
+                index.Offsets[first + k] = previous.Offsets[previousFirst + k] + shift;
+            }
+            continue;
+        }
+
+        const std::uint32_t *previousRow = source < previousGraph.airportCount() ? previousGraph.successorsBegin(source) : nullptr;
+        const std::uint32_t *previousRowEnd = source < previousGraph.airportCount() ? previousGraph.successorsEnd(source) : nullptr;
+        for (const std::uint32_t *destination = graph.successorsBegin(source); destination != graph.successorsEnd(source); destination++)
+        {
+            std::pair<std::uint32_t, std::uint32_t> key(source, *destination);
+            while (change != changed.end() && *change < key)
+            {
+                ++change;
+            }
+            while (previousRow != previousRowEnd && *previousRow < *destination)
+            {
+                ++previousRow;
+            }
+
+            if (change != changed.end() && *change == key)
+            {
+                while (route != routes.end() && std::make_pair(route->Source, route->Destination) < key)
+                {
+                    ++route;
+                }
+                for (; route != routes.end() && route->Source == source && route->Destination == *destination; ++route)
+                {
+                    index.Airlines.push_back(route->Operator);
+                }
+            }
+            else if (previousRow != previousRowEnd && *previousRow == *destination)
+            {
+                std::uint32_t edge = static_cast<std::uint32_t>(previousRow - previousGraph.neighbors().data());
+                if (edge < previous.routeCount())
+                {
+                    index.Airlines.insert(index.Airlines.end(), previous.airlinesBegin(edge), previous.airlinesEnd(edge));
+                }
+            }
+            std::size_t edge = static_cast<std::size_t>(destination - graph.neighbors().data());
+            index.Offsets[edge + 1] = static_cast<std::uint32_t>(index.Airlines.size());
+        }
+    }
+
+    return index;
+}
+
+/**
+ * @brief Gets a pointer to the first airline of a route.
+ *
+ * @param edge The index of the route in the graph's neighbors().
+ * @return A pointer to the first airline, the one with the fewest stops.
+ */
+const EdgeAirline *AirlineIndex::airlinesBegin(std::uint32_t edge) const
+{
+    return Airlines.data() + Offsets[edge];
+}
+
+/**
+ * @brief Gets a pointer one past the last airline of a route.
+ *
+ * @param edge The index of the route in the graph's neighbors().
+ * @return A pointer one past the last airline.
+ */
+const EdgeAirline *AirlineIndex::airlinesEnd(std::uint32_t edge) const
+{
+    return Airlines.data() + Offsets[edge + 1];
+}
+
+/**
+ * @brief Gets the number of routes in the index.
+ *
+ * @return The number of routes, which matches the graph the index was built for.
+ */
+std::size_t AirlineIndex::routeCount() const
+{
+    return Offsets.size() - 1;
+}
@@ -0,0 +1,105 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef AIRLINE_INDEX_H
+#define AIRLINE_INDEX_H
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include "flight_graph.h"
+#include "../Iata/iata.h"
+
+/**
+ * @struct EdgeAirline
+ * @brief One airline flying one route, packed into 8 bytes.
+ */
+struct EdgeAirline
+{
+    IataCode Airline; /**< The code of the airline. */
+    std::int32_t Stops; /**< The number of stops the airline makes on the route. */
+};
+
+/**
+ * @struct AirlineRoute
+ * @brief One row of the route file as the airline index is built from it: an airline flying between two airport ids.
+ */
+struct AirlineRoute
+{
+    std::uint32_t Source; /**< The id of the source airport. */
+    std::uint32_t Destination; /**< The id of the destination airport. */
+    EdgeAirline Operator; /**< The airline and its number of stops. */
+};
+
+/**
+ * @class AirlineIndex
+ * @brief The airlines flying every route of a FlightGraph, indexed by the route's position in the graph.
+ *
+ * The airlines of all routes are stored back to back in one packed array, with an offsets array marking where each
+ * route's airlines begin, just like the graph's own CSR arrays. Each route's airlines are sorted by stops, then
+ * airline code, so the first one is the most direct service.
+ */
+class AirlineIndex
+{
+
+private:
+    std::vector<std::uint32_t> Offsets; /**< Start of each route's airlines in Airlines; routeCount + 1 entries. */
+    std::vector<EdgeAirline> Airlines; /**< The airlines of every route, stored back to back. */
+
+public:
+    /**
+     * @brief Default constructor for the AirlineIndex class.
+     * Creates an empty index with no routes.
+     */
+    AirlineIndex();
+
+    /**
+     * @brief Builds the airline index of a graph.
+     * Rows naming a route the graph does not have are ignored, and an airline listed twice for a route is kept once.
+     *
+     * @param graph The route graph the index belongs to.
+     * @param routes Every airline route, in any order.
+     * @param threads The number of threads to build with, or 0 to use every hardware thread.
+     * @return The airline index.
+     */
+    static AirlineIndex build(const FlightGraph &graph, const std::vector<AirlineRoute> &routes, unsigned threads = 0);
+
+    /**
+     * @brief Builds the airline index of a changed graph from the index of the graph it was changed from.
+     * The airlines of the changed routes are taken from a list; every other route keeps its airlines, copied from
+     * the previous index, so the result matches an index built from every airline route of the changed graph.
+     * Every airline is copied and every offset rewritten, so the time grows with the whole index.
+     *
+     * @param graph The changed graph.
+     * @param previousGraph The graph the previous index belongs to.
+     * @param previous The index of previousGraph.
+     * @param changed The routes whose airlines changed, as (source, destination) ids.
+     * @param routes Every airline of the changed routes, in any order; rows of other routes are ignored.
+     * @return The airline index of the changed graph.
+     */
+    static AirlineIndex update(const FlightGraph &graph, const FlightGraph &previousGraph, const AirlineIndex &previous, std::vector<std::pair<std::uint32_t, std::uint32_t>> changed, std::vector<AirlineRoute> routes);
+
+    /**
+     * @brief Gets a pointer to the first airline of a route.
+     *
+     * @param edge The index of the route in the graph's neighbors().
+     * @return A pointer to the first airline, the one with the fewest stops.
+     */
+    const EdgeAirline *airlinesBegin(std::uint32_t edge) const;
+
+    /**
+     * @brief Gets a pointer one past the last airline of a route.
+     *
+     * @param edge The index of the route in the graph's neighbors().
+     * @return A pointer one past the last airline.
+     */
+    const EdgeAirline *airlinesEnd(std::uint32_t edge) const;
+
+    /**
+     * @brief Gets the number of routes in the index.
+     *
+     * @return The number of routes, which matches the graph the index was built for.
+     */
+    std::size_t routeCount() const;
+};
+
+#endif // AIRLINE_INDEX_H
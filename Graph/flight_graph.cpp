@@ -0,0 +1,507 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include "flight_graph.h"
+#include "../Haversine/haversine.h"
+#include "../Haversine/haversine_batch.h"
+#include "../ThreadPool/thread_pool.h"
+
+/**
+ * @brief The number of source airports turned into rows by one task of the thread pool.
+ */
+static const std::size_t SourcesPerTask = 64;
+
+/**
+ * @brief Default constructor for the FlightGraph class.
+ * Creates an empty graph with no airports and no routes.
+ */
+FlightGraph::FlightGraph()
+{
+    this->Offsets.push_back(0);
+    this->ReverseOffsets.push_back(0);
+}
+
+/**
+ * @brief Builds the reverse adjacency arrays from the forward ones.
+ * A counting sort by destination, so the predecessors of every airport come out sorted like its successors.
+ */
+void FlightGraph::buildReverse()
+{
+    ReverseOffsets.assign(airportCount() + 1, 0);
+    for (auto const &destination : Neighbors)
+    {
+        ReverseOffsets[destination + 1]++;
+    }
+    for (std::uint32_t id = 0; id < airportCount(); id++)
+    {
+        ReverseOffsets[id + 1] += ReverseOffsets[id];
+    }
+
+    Predecessors.resize(Neighbors.size());
+    ReverseRoutes.resize(Neighbors.size());
+    std::vector<std::uint32_t> next(ReverseOffsets.begin(), ReverseOffsets.end() - 1);
+    for (std::uint32_t source = 0; source < airportCount(); source++)
+    {
+        for (std::uint32_t edge = Offsets[source]; edge < Offsets[source + 1]; edge++)
+        {
+            std::uint32_t slot = next[Neighbors[edge]]++;
+            Predecessors[slot] = source;
+            ReverseRoutes[slot] = edge;
+        }
+    }
+    ReverseDistances.clear();
+}
+
+/**
+ * @brief Builds a graph from a map of airport codes and their routes.
+ *
+ * Every airport in the route map must already be interned in the id table. Airports of the table without
+ * routes are part of the graph with no successors. Duplicate routes between the same pair of airports
+ * (for example the same route flown by several airlines) are stored once.
+ *
+ * Each airport's row is sorted and deduplicated on the thread pool, a block of sources per task; only the short
+ * layout of the rows and the reverse arrays run on one thread.
+ *
+ * @param routeMap A map of source airport codes to the codes of the airports they have routes to.
+ * @param ids The table numbering the airports.
+ * @param threads The number of threads to build the rows with, or 0 to use every hardware thread.
+ * @return The graph describing the given routes.
+ */
+FlightGraph FlightGraph::fromRouteMap(const std::map<IataCode, std::vector<IataCode>> &routeMap, const IataTable &ids, unsigned threads)
+{
+    FlightGraph graph;
+
+    // collect each airport's successors, then lay the rows out back to back; every task writes only its own rows
+    std::vector<const std::pair<const IataCode, std::vector<IataCode>> *> sources;
+    sources.reserve(routeMap.size());
+    for (auto const &pair : routeMap)
+    {
+        sources.push_back(&pair);
+    }
+    std::vector<std::vector<std::uint32_t>> rows(ids.size());
+    {
+        ThreadPool pool(threads);
+        for (std::size_t first = 0; first < sources.size(); first += SourcesPerTask)
+        {
+            pool.submit([&sources, &rows, &ids, first]()
+                        {
+                            std::size_t last = std::min(sources.size(), first + SourcesPerTask);
+                            for (std::size_t i = first; i < last; i++)
+                            {
+                                std::vector<std::uint32_t> &row = rows[ids.find(sources[i]->first)];
+                                row.reserve(sources[i]->second.size());
+                                for (auto const &destination : sources[i]->second)
+                                {
+                                    row.push_back(ids.find(destination));
+                                }
+                                std::sort(row.begin(), row.end());
+                                row.erase(std::unique(row.begin(), row.end()), row.end());
+                            } });
+        }
+        pool.wait();
+    }
+
+    graph.Offsets.assign(rows.size() + 1, 0);
+    for (std::uint32_t id = 0; id < rows.size(); id++)
+    {
+        graph.Offsets[id + 1] = graph.Offsets[id] + static_cast<std::uint32_t>(rows[id].size());
+    }
+    graph.Neighbors.reserve(graph.Offsets.back());
+    for (auto const &row : rows)
+    {
+        graph.Neighbors.insert(graph.Neighbors.end(), row.begin(), row.end());
+    }
+    graph.buildReverse();
+
+    return graph;
+}
+
+/**
+ * @brief Builds a graph from CSR arrays, such as the arrays of a saved graph.
+ *
+ * @param offsets The start of each airport's successors; airportCount + 1 entries.
+ * @param airportCount The number of airports in the graph.
+ * @param neighbors The successor ids of every airport, stored back to back; offsets[airportCount] entries.
+ * @return The graph described by the arrays.
+ */
+FlightGraph FlightGraph::fromArrays(const std::uint32_t *offsets, std::uint32_t airportCount, const std::uint32_t *neighbors)
+{
+    FlightGraph graph;
+    graph.Offsets.assign(offsets, offsets + airportCount + 1);
+    graph.Neighbors.assign(neighbors, neighbors + offsets[airportCount]);
+    graph.buildReverse();
+    return graph;
+}
+
+/**
+ * @brief Measures the routes of one airport with the haversine formula.
+ * The airport's successors are gathered into a contiguous batch and the whole row is measured in one call.
+ *
+ * @param source The id of the airport.
+ * @param latitudes The latitude of every airport in degrees, indexed by id.
+ * @param longitudes The longitude of every airport in degrees, indexed by id.
+ * @param rowLatitudes Scratch space for the latitudes of the row.
+ * @param rowLongitudes Scratch space for the longitudes of the row.
+ */
+void FlightGraph::measureRow(std::uint32_t source, const std::vector<double> &latitudes, const std::vector<double> &longitudes, std::vector<double> &rowLatitudes, std::vector<double> &rowLongitudes)
+{
+    rowLatitudes.clear();
+    rowLongitudes.clear();
+    for (std::uint32_t edge = Offsets[source]; edge < Offsets[source + 1]; edge++)
+    {
+        rowLatitudes.push_back(latitudes[Neighbors[edge]]);
+        rowLongitudes.push_back(longitudes[Neighbors[edge]]);
+    }
+    haversineFrom(latitudes[source], longitudes[source], rowLatitudes.data(), rowLongitudes.data(), Distances.data() + Offsets[source], degree(source));
+    for (std::uint32_t edge = Offsets[source]; edge < Offsets[source + 1]; edge++)
+    {
+        if (std::isnan(Distances[edge]))
+        {
+            Distances[edge] = std::numeric_limits<double>::infinity();
+        }
+    }
+}
+
+/**
+ * @brief Copies the length of every route into the reverse arrays, in the order of Predecessors.
+ */
+void FlightGraph::copyReverseDistances()
+{
+    ReverseDistances.resize(ReverseRoutes.size());
+    for (std::size_t slot = 0; slot < ReverseRoutes.size(); slot++)
+    {
+        ReverseDistances[slot] = Distances[ReverseRoutes[slot]];
+    }
+}
+
+/**
+ * @brief Measures every route of the graph with the haversine formula.
+ *
+ * Routes to or from an airport without coordinates (given as NaN) cannot be measured and get an infinite
+ * length, so distance searches never use them. The positions are kept for distanceBetween and distanceBound.
+ *
+ * @param latitudes The latitude of every airport in degrees, indexed by id.
+ * @param longitudes The longitude of every airport in degrees, indexed by id.
+ */
+void FlightGraph::weighRoutes(const std::vector<double> &latitudes, const std::vector<double> &longitudes)
+{
+    Points.resize(latitudes.size());
+    for (std::uint32_t id = 0; id < latitudes.size(); id++)
+    {
+        Points[id] = haversinePoint(latitudes[id], longitudes[id]);
+    }
+    Distances.resize(Neighbors.size());
+
+    std::vector<double> rowLatitudes;
+    std::vector<double> rowLongitudes;
+    for (std::uint32_t source = 0; source < airportCount(); source++)
+    {
+        measureRow(source, latitudes, longitudes, rowLatitudes, rowLongitudes);
+    }
+    copyReverseDistances();
+}
+
+/**
+ * @brief Builds a copy of the graph with some routes added and others removed.
+ *
+ * The rows of airports whose routes did not change are copied along with their lengths; only the rows that changed
+ * are merged with the changes and measured again, each in one batch like weighRoutes measures it. The haversine
+ * kernels give every route the same length whatever batch it is measured in, so the copy is identical to a graph
+ * built from the changed routes and measured from scratch. The reverse arrays are rebuilt with a counting sort.
+ * Only the measuring grows with the changes: copying the rows and rebuilding the reverse arrays are passes over the
+ * whole graph.
+ *
+ * @param airportCount The number of airports of the new graph, at least airportCount(); new airports get the ids
+ * after the existing ones.
+ * @param added The routes to add, as (source, destination) ids below airportCount; routes the graph has are ignored.
+ * @param removed The routes to remove, as (source, destination) ids; routes the graph does not have are ignored.
+ * @param latitudes The latitude of every airport of the new graph in degrees, indexed by id, or NaN if unknown;
+ * only the airports of the changed rows and the new airports are read.
+ * @param longitudes The longitude of every airport of the new graph in degrees, indexed by id, or NaN if unknown;
+ * only the airports of the changed rows and the new airports are read.
+ * @return The changed graph, measured if this graph was measured.
+ */
+FlightGraph FlightGraph::withRoutes(std::uint32_t airportCount, std::vector<std::pair<std::uint32_t, std::uint32_t>> added, std::vector<std::pair<std::uint32_t, std::uint32_t>> removed, const std::vector<double> &latitudes, const std::vector<double> &longitudes) const
+{
+    FlightGraph graph;
+    bool measured = Distances.size() == Neighbors.size() && Points.size() == this->airportCount();
+
+    // sorted like the rows, so every changed row is merged with its changes in one pass
+    std::sort(added.begin(), added.end());
+    added.erase(std::unique(added.begin(), added.end()), added.end());
+    std::sort(removed.begin(), removed.end());
+    auto add = added.begin();
+    auto remove = removed.begin();
+
+    graph.Offsets.assign(airportCount + 1, 0);
+    graph.Neighbors.reserve(Neighbors.size() + added.size());
+    if (measured)
+    {
+        graph.Distances.reserve(Neighbors.size() + added.size());
+    }
+    std::vector<std::uint32_t> changedRows;
+    for (std::uint32_t source = 0; source < airportCount; source++)
+    {
+        const std::uint32_t *row = source < this->airportCount() ? successorsBegin(source) : nullptr;
+        const std::uint32_t *rowEnd = source < this->airportCount() ? successorsEnd(source) : nullptr;
+        bool adding = add != added.end() && add->first == source;
+        bool removing = remove != removed.end() && remove->first == source;
+        if (!adding && !removing)
+        {
+            // an unchanged row keeps its lengths
+            graph.Neighbors.insert(graph.Neighbors.end(), row, rowEnd);
+            if (measured && row != rowEnd)
+            {
+                graph.Distances.insert(graph.Distances.end(), distancesBegin(source), distancesBegin(source) + degree(source));
+            }
+        }
+        else
+        {
+            while (row != rowEnd || (add != added.end() && add->first == source))
+            {
+                if (add != added.end() && add->first == source && (row == rowEnd || add->second <= *row))
+                {
+                    // an added route the graph already has is kept once
+                    if (row == rowEnd || add->second < *row)
+                    {
+                        graph.Neighbors.push_back(add->second);
+                    }
+                    ++add;
+                    continue;
+                }
+                while (remove != removed.end() && remove->first == source && remove->second < *row)
+                {
+                    ++remove;
+                }
+                if (remove != removed.end() && remove->first == source && remove->second == *row)
+                {
+                    ++remove;
+                }
+                else
+                {
+                    graph.Neighbors.push_back(*row);
+                }
+                ++row;
+            }
+            while (remove != removed.end() && remove->first == source)
+            {
+                ++remove;
+            }
+            changedRows.push_back(source);
+            if (measured)
+            {
+                graph.Distances.resize(graph.Neighbors.size());
+            }
+        }
+        graph.Offsets[source + 1] = static_cast<std::uint32_t>(graph.Neighbors.size());
+    }
+    graph.buildReverse();
+    if (!measured)
+    {
+        return graph;
+    }
+
+    // a changed row is measured again as a whole, in one batch
+    std::vector<double> rowLatitudes;
+    std::vector<double> rowLongitudes;
+    for (auto const &source : changedRows)
+    {
+        graph.measureRow(source, latitudes, longitudes, rowLatitudes, rowLongitudes);
+    }
+    graph.Points = Points;
+    graph.Points.resize(airportCount);
+    for (std::uint32_t id = this->airportCount(); id < airportCount; id++)
+    {
+        graph.Points[id] = haversinePoint(latitudes[id], longitudes[id]);
+    }
+    graph.copyReverseDistances();
+    return graph;
+}
+
+/**
+ * @brief Gets the offsets array of the graph.
+ *
+ * @return The start of each airport's successors in neighbors(); airportCount() + 1 entries.
+ */
+const std::vector<std::uint32_t> &FlightGraph::offsets() const
+{
+    return Offsets;
+}
+
+/**
+ * @brief Gets the neighbor array of the graph.
+ *
+ * @return The successor ids of every airport, stored back to back.
+ */
+const std::vector<std::uint32_t> &FlightGraph::neighbors() const
+{
+    return Neighbors;
+}
+
+/**
+ * @brief Gets the number of airports in the graph.
+ *
+ * @return The number of airports.
+ */
+std::uint32_t FlightGraph::airportCount() const
+{
+    return static_cast<std::uint32_t>(Offsets.size() - 1);
+}
+
+/**
+ * @brief Gets the number of distinct routes in the graph.
+ *
+ * @return The number of routes.
+ */
+std::size_t FlightGraph::routeCount() const
+{
+    return Neighbors.size();
+}
+
+/**
+ * @brief Gets the number of airports that can be reached directly from an airport.
+ *
+ * @param id The id of the airport.
+ * @return The number of successors of the airport.
+ */
+std::uint32_t FlightGraph::degree(std::uint32_t id) const
+{
+    return Offsets[id + 1] - Offsets[id];
+}
+
+/**
+ * @brief Gets a pointer to the first successor of an airport.
+ *
+ * @param id The id of the airport.
+ * @return A pointer to the first successor id.
+ */
+const std::uint32_t *FlightGraph::successorsBegin(std::uint32_t id) const
+{
+    return Neighbors.data() + Offsets[id];
+}
+
+/**
+ * @brief Gets a pointer one past the last successor of an airport.
+ *
+ * @param id The id of the airport.
+ * @return A pointer one past the last successor id.
+ */
+const std::uint32_t *FlightGraph::successorsEnd(std::uint32_t id) const
+{
+    return Neighbors.data() + Offsets[id + 1];
+}
+
+/**
+ * @brief Gets a pointer to the first predecessor of an airport, an airport with a route to it.
+ *
+ * @param id The id of the airport.
+ * @return A pointer to the first predecessor id.
+ */
+const std::uint32_t *FlightGraph::predecessorsBegin(std::uint32_t id) const
+{
+    return Predecessors.data() + ReverseOffsets[id];
+}
+
+/**
+ * @brief Gets a pointer one past the last predecessor of an airport.
+ *
+ * @param id The id of the airport.
+ * @return A pointer one past the last predecessor id.
+ */
+const std::uint32_t *FlightGraph::predecessorsEnd(std::uint32_t id) const
+{
+    return Predecessors.data() + ReverseOffsets[id + 1];
+}
+
+/**
+ * @brief Finds the route between two airports.
+ * The successors of every airport are sorted, so this is a binary search over one row.
+ *
+ * @param source The id of the airport the route leaves.
+ * @param destination The id of the airport the route arrives at.
+ * @return The index of the route in neighbors(), or IataTable::NoId if there is no such route.
+ */
+std::uint32_t FlightGraph::findEdge(std::uint32_t source, std::uint32_t destination) const
+{
+    if (source >= airportCount())
+    {
+        return IataTable::NoId;
+    }
+    const std::uint32_t *found = std::lower_bound(successorsBegin(source), successorsEnd(source), destination);
+    if (found == successorsEnd(source) || *found != destination)
+    {
+        return IataTable::NoId;
+    }
+    return static_cast<std::uint32_t>(found - Neighbors.data());
+}
+
+/**
+ * @brief Gets the length of a route.
+ * Only available once weighRoutes has run.
+ *
+ * @param edge The index of the route in neighbors(), as returned by findEdge.
+ * @return The length of the route in kilometers, or infinity if it could not be measured.
+ */
+double FlightGraph::routeDistance(std::uint32_t edge) const
+{
+    return Distances[edge];
+}
+
+/**
+ * @brief Gets a pointer to the length of the route to an airport's first successor.
+ * The lengths of an airport's routes line up with its successors; they are only available once weighRoutes has run.
+ *
+ * @param id The id of the airport.
+ * @return A pointer to the length in kilometers of the airport's first route.
+ */
+const double *FlightGraph::distancesBegin(std::uint32_t id) const
+{
+    return Distances.data() + Offsets[id];
+}
+
+/**
+ * @brief Gets a pointer to the length of the route from an airport's first predecessor.
+ * The lengths line up with the predecessors; they are only available once weighRoutes has run.
+ *
+ * @param id The id of the airport.
+ * @return A pointer to the length in kilometers of the route from the airport's first predecessor.
+ */
+const double *FlightGraph::reverseDistancesBegin(std::uint32_t id) const
+{
+    return ReverseDistances.data() + ReverseOffsets[id];
+}
+
+/**
+ * @brief Gets the great-circle distance between two airports.
+ * Only available once weighRoutes has run.
+ *
+ * @param from The id of the first airport.
+ * @param to The id of the second airport.
+ * @return The distance in kilometers, or 0 if either airport has no coordinates.
+ */
+double FlightGraph::distanceBetween(std::uint32_t from, std::uint32_t to) const
+{
+    double distance = haversine(Points[from], Points[to]);
+    return std::isnan(distance) ? 0 : distance;
+}
+
+/**
+ * @brief Quickly estimates the great-circle distance between two airports from below, as a lower bound on the
+ * length of any route between them. Only available once weighRoutes has run.
+ *
+ * @param from The id of the first airport.
+ * @param to The id of the second airport.
+ * @return A lower bound on the distance in kilometers, or 0 if either airport has no coordinates.
+ */
+double FlightGraph::distanceBound(std::uint32_t from, std::uint32_t to) const
+{
+    double distance = haversineBound(Points[from], Points[to]);
+    return std::isnan(distance) ? 0 : distance;
+}
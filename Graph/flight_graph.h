@@ -0,0 +1,244 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef FLIGHT_GRAPH_H
+#define FLIGHT_GRAPH_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include "../Iata/iata.h"
+#include "../Haversine/haversine.h"
+
+/**
+ * @class FlightGraph
+ * @brief An immutable compressed sparse row (CSR) representation of the route network.
+ *
+ * Airports are identified by the dense ids of an IataTable. The successors of an airport
+ * are stored contiguously in a single neighbor array, and an offsets array marks where the successors of
+ * each airport begin and end. Expanding an airport during a search is therefore a walk over one small,
+ * contiguous slice of memory instead of a map lookup followed by a copy of a vector of strings.
+ * The same routes are also stored the other way round, by destination, so searches can run backwards from a goal.
+ */
+class FlightGraph
+{
+
+private:
+    std::vector<std::uint32_t> Offsets; /**< Start of each airport's successors in Neighbors; has airportCount() + 1 entries. */
+    std::vector<std::uint32_t> Neighbors; /**< The successor ids of every airport, stored back to back. */
+    std::vector<double> Distances; /**< The great-circle length in kilometers of every route, parallel to Neighbors. */
+    std::vector<HaversinePoint> Points; /**< The position of every airport, prepared for distance calculations. */
+    std::vector<std::uint32_t> ReverseOffsets; /**< Start of each airport's predecessors in Predecessors; has airportCount() + 1 entries. */
+    std::vector<std::uint32_t> Predecessors; /**< The predecessor ids of every airport, stored back to back. */
+    std::vector<std::uint32_t> ReverseRoutes; /**< The index in Neighbors of every route, parallel to Predecessors. */
+    std::vector<double> ReverseDistances; /**< The great-circle length in kilometers of every route, parallel to Predecessors. */
+
+    /**
+     * @brief Builds the reverse adjacency arrays from the forward ones.
+     */
+    void buildReverse();
+
+    /**
+     * @brief Measures the routes of one airport with the haversine formula.
+     *
+     * @param source The id of the airport.
+     * @param latitudes The latitude of every airport in degrees, indexed by id.
+     * @param longitudes The longitude of every airport in degrees, indexed by id.
+     * @param rowLatitudes Scratch space for the latitudes of the row.
+     * @param rowLongitudes Scratch space for the longitudes of the row.
+     */
+    void measureRow(std::uint32_t source, const std::vector<double> &latitudes, const std::vector<double> &longitudes, std::vector<double> &rowLatitudes, std::vector<double> &rowLongitudes);
+
+    /**
+     * @brief Copies the length of every route into the reverse arrays.
+     */
+    void copyReverseDistances();
+
+public:
+    /**
+     * @brief Default constructor for the FlightGraph class.
+     * Creates an empty graph with no airports and no routes.
+     */
+    FlightGraph();
+
+    /**
+     * @brief Builds a graph from a map of airport codes and their routes.
+     *
+     * Every airport in the route map must already be interned in the id table. Airports of the table without
+     * routes are part of the graph with no successors. Duplicate routes between the same pair of airports
+     * (for example the same route flown by several airlines) are stored once.
+     *
+     * @param routeMap A map of source airport codes to the codes of the airports they have routes to.
+     * @param ids The table numbering the airports.
+     * @param threads The number of threads to build the rows with, or 0 to use every hardware thread.
+     * @return The graph describing the given routes.
+     */
+    static FlightGraph fromRouteMap(const std::map<IataCode, std::vector<IataCode>> &routeMap, const IataTable &ids, unsigned threads = 0);
+
+    /**
+     * @brief Builds a graph from CSR arrays, such as the arrays of a saved graph.
+     *
+     * @param offsets The start of each airport's successors; airportCount + 1 entries.
+     * @param airportCount The number of airports in the graph.
+     * @param neighbors The successor ids of every airport, stored back to back; offsets[airportCount] entries.
+     * @return The graph described by the arrays.
+     */
+    static FlightGraph fromArrays(const std::uint32_t *offsets, std::uint32_t airportCount, const std::uint32_t *neighbors);
+
+    /**
+     * @brief Measures every route of the graph with the haversine formula.
+     *
+     * Routes to or from an airport without coordinates (given as NaN) cannot be measured and get an infinite
+     * length, so distance searches never use them. The positions are kept for distanceBetween and distanceBound.
+     *
+     * @param latitudes The latitude of every airport in degrees, indexed by id.
+     * @param longitudes The longitude of every airport in degrees, indexed by id.
+     */
+    void weighRoutes(const std::vector<double> &latitudes, const std::vector<double> &longitudes);
+
+    /**
+     * @brief Builds a copy of the graph with some routes added and others removed.
+     * Only the rows of airports whose routes changed are rebuilt and measured again; every other row is copied with
+     * its lengths, so the copy matches a graph built and measured from the changed routes. Copying the rows and
+     * rebuilding the reverse arrays still take time in proportion to the whole graph.
+     *
+     * @param airportCount The number of airports of the new graph, at least airportCount(); new airports get the ids
+     * after the existing ones.
+     * @param added The routes to add, as (source, destination) ids below airportCount; routes the graph has are ignored.
+     * @param removed The routes to remove, as (source, destination) ids; routes the graph does not have are ignored.
+     * @param latitudes The latitude of every airport of the new graph in degrees, indexed by id, or NaN if unknown;
+     * only the airports of the changed rows and the new airports are read.
+     * @param longitudes The longitude of every airport of the new graph in degrees, indexed by id, or NaN if unknown;
+     * only the airports of the changed rows and the new airports are read.
+     * @return The changed graph, measured if this graph was measured.
+     */
+    FlightGraph withRoutes(std::uint32_t airportCount, std::vector<std::pair<std::uint32_t, std::uint32_t>> added, std::vector<std::pair<std::uint32_t, std::uint32_t>> removed, const std::vector<double> &latitudes, const std::vector<double> &longitudes) const;
+
+    /**
+     * @brief Gets the offsets array of the graph.
+     *
+     * @return The start of each airport's successors in neighbors(); airportCount() + 1 entries.
+     */
+    const std::vector<std::uint32_t> &offsets() const;
+
+    /**
+     * @brief Gets the neighbor array of the graph.
+     *
+     * @return The successor ids of every airport, stored back to back.
+     */
+    const std::vector<std::uint32_t> &neighbors() const;
+
+    /**
+     * @brief Gets the number of airports in the graph.
+     *
+     * @return The number of airports.
+     */
+    std::uint32_t airportCount() const;
+
+    /**
+     * @brief Gets the number of distinct routes in the graph.
+     *
+     * @return The number of routes.
+     */
+    std::size_t routeCount() const;
+
+    /**
+     * @brief Gets the number of airports that can be reached directly from an airport.
+     *
+     * @param id The id of the airport.
+     * @return The number of successors of the airport.
+     */
+    std::uint32_t degree(std::uint32_t id) const;
+
+    /**
+     * @brief Gets a pointer to the first successor of an airport.
+     *
+     * @param id The id of the airport.
+     * @return A pointer to the first successor id.
+     */
+    const std::uint32_t *successorsBegin(std::uint32_t id) const;
+
+    /**
+     * @brief Gets a pointer one past the last successor of an airport.
+     *
+     * @param id The id of the airport.
+     * @return A pointer one past the last successor id.
+     */
+    const std::uint32_t *successorsEnd(std::uint32_t id) const;
+
+    /**
+     * @brief Gets a pointer to the first predecessor of an airport, an airport with a route to it.
+     *
+     * @param id The id of the airport.
+     * @return A pointer to the first predecessor id.
+     */
+    const std::uint32_t *predecessorsBegin(std::uint32_t id) const;
+
+    /**
+     * @brief Gets a pointer one past the last predecessor of an airport.
+     *
+     * @param id The id of the airport.
+     * @return A pointer one past the last predecessor id.
+     */
+    const std::uint32_t *predecessorsEnd(std::uint32_t id) const;
+
+    /**
+     * @brief Gets a pointer to the length of the route from an airport's first predecessor.
+     * The lengths line up with the predecessors; they are only available once weighRoutes has run.
+     *
+     * @param id The id of the airport.
+     * @return A pointer to the length in kilometers of the route from the airport's first predecessor.
+     */
+    const double *reverseDistancesBegin(std::uint32_t id) const;
+
+    /**
+     * @brief Finds the route between two airports.
+     * The successors of every airport are sorted, so this is a binary search over one row.
+     *
+     * @param source The id of the airport the route leaves.
+     * @param destination The id of the airport the route arrives at.
+     * @return The index of the route in neighbors(), or IataTable::NoId if there is no such route.
+     */
+    std::uint32_t findEdge(std::uint32_t source, std::uint32_t destination) const;
+
+    /**
+     * @brief Gets the length of a route.
+     * Only available once weighRoutes has run.
+     *
+     * @param edge The index of the route in neighbors(), as returned by findEdge.
+     * @return The length of the route in kilometers, or infinity if it could not be measured.
+     */
+    double routeDistance(std::uint32_t edge) const;
+
+    /**
+     * @brief Gets a pointer to the length of the route to an airport's first successor.
+     * The lengths of an airport's routes line up with its successors; they are only available once weighRoutes has run.
+     *
+     * @param id The id of the airport.
+     * @return A pointer to the length in kilometers of the airport's first route.
+     */
+    const double *distancesBegin(std::uint32_t id) const;
+
+    /**
+     * @brief Gets the great-circle distance between two airports.
+     * Only available once weighRoutes has run.
+     *
+     * @param from The id of the first airport.
+     * @param to The id of the second airport.
+     * @return The distance in kilometers, or 0 if either airport has no coordinates.
+     */
+    double distanceBetween(std::uint32_t from, std::uint32_t to) const;
+
+    /**
+     * @brief Quickly estimates the great-circle distance between two airports from below, as a lower bound on the
+     * length of any route between them. See haversineBound for its accuracy. Only available once weighRoutes has run.
+     *
+     * @param from The id of the first airport.
+     * @param to The id of the second airport.
+     * @return A lower bound on the distance in kilometers, or 0 if either airport has no coordinates.
+     */
+    double distanceBound(std::uint32_t from, std::uint32_t to) const;
+};
+
+#endif // FLIGHT_GRAPH_H
@@ -26,12 +26,73 @@ double haversine(double lat1, double lon1, double lat2, double lon2)
     lat2 = (lat2)*M_PI / 180.0;
 
     // apply formulae
-    double a = pow(sin(dLat / 2), 2) + pow(sin(dLon / 2), 2) * cos(lat1) * cos(lat2);
+    double sinLat = sin(dLat / 2);
+    double sinLon = sin(dLon / 2);
+    double a = sinLat * sinLat + sinLon * sinLon * cos(lat1) * cos(lat2);
     double rad = 6371;
     double c = 2 * asin(sqrt(a));
     return rad * c;
 }
 
+/**
+ * @brief Prepares a point for repeated distance calculations.
+ *
+ * @param lat The latitude of the point in degrees.
+ * @param lon The longitude of the point in degrees.
+ * @return The prepared point.
+ */
+HaversinePoint haversinePoint(double lat, double lon)
+{
+    HaversinePoint point;
+    point.Latitude = (lat)*M_PI / 180.0;
+    point.Longitude = (lon)*M_PI / 180.0;
+    point.CosLatitude = cos(point.Latitude);
+    return point;
+}
+
+/**
+ * @brief Calculates the distance between two prepared points using the Haversine formula.
+ *
+ * @param from The first point.
+ * @param to The second point.
+ * @return The distance between the two points in kilometers.
+ */
+double haversine(const HaversinePoint &from, const HaversinePoint &to)
+{
+    double sinLat = sin((to.Latitude - from.Latitude) / 2);
+    double sinLon = sin((to.Longitude - from.Longitude) / 2);
+    double a = sinLat * sinLat + sinLon * sinLon * from.CosLatitude * to.CosLatitude;
+    double rad = 6371;
+    double c = 2 * asin(sqrt(a));
+    return rad * c;
+}
+
+/**
+ * @brief Quickly estimates the distance between two prepared points from below, without calling any trigonometric function.
+ *
+ * @param from The first point.
+ * @param to The second point.
+ * @return A lower bound on the distance between the two points in kilometers.
+ */
+double haversineBound(const HaversinePoint &from, const HaversinePoint &to)
+{
+    // half the angles between the points, both within [0, pi / 2]
+    double halfLat = fabs(to.Latitude - from.Latitude) / 2;
+    double halfLon = fabs(to.Longitude - from.Longitude);
+    halfLon = (halfLon > M_PI ? 2 * M_PI - halfLon : halfLon) / 2;
+
+    // the Taylor series of sin cut after a negative term never exceeds sin(x) there, and the all-positive series
+    // of asin never exceeds asin(x)
+    double zLat = halfLat * halfLat;
+    double zLon = halfLon * halfLon;
+    double sinLat = halfLat * (1 - zLat / 6 * (1 - zLat / 20 * (1 - zLat / 42)));
+    double sinLon = halfLon * (1 - zLon / 6 * (1 - zLon / 20 * (1 - zLon / 42)));
+    double a = sinLat * sinLat + sinLon * sinLon * from.CosLatitude * to.CosLatitude;
+    double rad = 6371;
+    double c = 2 * sqrt(a) * (1 + a * (1.0 / 6 + a * (3.0 / 40 + a * (15.0 / 336 + a * (105.0 / 3456)))));
+    return rad * c;
+}
+
 // // Driver code
 // int main()
 // {
@@ -15,4 +15,49 @@
  */
 double haversine(double lat1, double lon1, double lat2, double lon2);
 
+/**
+ * @struct HaversinePoint
+ * @brief A point on the Earth's surface with the parts of the haversine formula that depend on it alone computed once.
+ * Coordinates are in radians; all fields are NaN for a point with unknown coordinates.
+ */
+struct HaversinePoint
+{
+    double Latitude;    /**< The latitude of the point in radians. */
+    double Longitude;   /**< The longitude of the point in radians. */
+    double CosLatitude; /**< The cosine of the latitude. */
+};
+
+/**
+ * @brief Prepares a point for repeated distance calculations.
+ *
+ * @param lat The latitude of the point in degrees.
+ * @param lon The longitude of the point in degrees.
+ * @return The prepared point.
+ */
+HaversinePoint haversinePoint(double lat, double lon);
+
+/**
+ * @brief Calculates the distance between two prepared points using the Haversine formula.
+ * Agrees with haversine() on the points' coordinates in degrees up to rounding, without converting them or taking their cosines.
+ *
+ * @param from The first point.
+ * @param to The second point.
+ * @return The distance between the two points in kilometers.
+ */
+double haversine(const HaversinePoint &from, const HaversinePoint &to);
+
+/**
+ * @brief Quickly estimates the distance between two prepared points from below, without calling any trigonometric function.
+ *
+ * The sines and the arcsine of the Haversine formula are replaced by the first terms of their Taylor series, each of
+ * which is a lower bound, so the estimate never exceeds the exact distance; this makes it safe as a search
+ * heuristic. It is at most 0.017% short for points up to 5,000 km apart, 0.022% up to 7,000 km, 0.13% up to
+ * 10,000 km, 1% up to 13,000 km, and 17% short for points on opposite sides of the Earth.
+ *
+ * @param from The first point.
+ * @param to The second point.
+ * @return A lower bound on the distance between the two points in kilometers.
+ */
+double haversineBound(const HaversinePoint &from, const HaversinePoint &to);
+
 #endif // HAVERSINE_H 
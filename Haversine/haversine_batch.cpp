@@ -0,0 +1,388 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <cmath>
+#include <cstddef>
+#include <atomic>
+#include "haversine_batch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVERSINE_X86 1
+#include <immintrin.h>
+#endif
+
+static const double EarthRadius = 6371.0;
+static const double Pi = 3.14159265358979323846;
+static const double HalfPi = Pi / 2;
+static const double HalfRadians = Pi / 360; // half of one degree in radians
+
+// sin(x) = x + x * z * P(z) with z = x * x, fitted on [0, pi / 2]; absolute error below 5e-16
+static const int SinTerms = 8;
+static const double SinCoefficients[SinTerms] = {
+    -0.16666666666666671,
+    0.0083333333333356283,
+    -0.00019841269842598198,
+    2.7557319513775786e-06,
+    -2.5052139270825129e-08,
+    1.606076390135146e-10,
+    -7.6947768924338335e-13,
+    3.3050952503962883e-15};
+
+// asin(x) = x + x * z * P(z) with z = x * x, fitted on [0, 0.5]; absolute error below 1e-16
+static const int AsinTerms = 13;
+static const double AsinCoefficients[AsinTerms] = {
+    0.16666666666666688,
+    0.074999999999834838,
+    0.044642857166261388,
+    0.030381943003236329,
+    0.022372208228457119,
+    0.017351724405243379,
+    0.013979408214379593,
+    0.011412042850063595,
+    0.010693631431957526,
+    0.0040939511374934283,
+    0.02059892635233937,
+    -0.019177984703634524,
+    0.031324483922975307};
+
+/**
+ * @brief Calculates sin(x) for |x| <= pi, or the sine of pi - |x| which has the same square.
+ * Only squares and cosines of latitudes are needed, so the sign of the result is dropped.
+ */
+static inline double sinScalar(double x)
+{
+    x = std::fabs(x);
+    x = x > HalfPi ? Pi - x : x;
+    double z = x * x;
+    double p = SinCoefficients[SinTerms - 1];
+    for (int i = SinTerms - 2; i >= 0; i--)
+    {
+        p = p * z + SinCoefficients[i];
+    }
+    return x + x * z * p;
+}
+
+/**
+ * @brief Calculates asin(sqrt(a)) for 0 <= a <= 1.
+ * Above a = 0.25 the identity asin(s) = pi / 2 - 2 asin(sqrt((1 - s) / 2)) keeps the polynomial on [0, 0.5].
+ */
+static inline double asinSqrtScalar(double a)
+{
+    a = a > 1 ? 1 : a;
+    double s = std::sqrt(a);
+    bool small = a <= 0.25;
+    double z = small ? a : (1 - s) * 0.5;
+    double x = small ? s : std::sqrt(z);
+    double p = AsinCoefficients[AsinTerms - 1];
+    for (int i = AsinTerms - 2; i >= 0; i--)
+    {
+        p = p * z + AsinCoefficients[i];
+    }
+    double asin = x + x * z * p;
+    return small ? asin : HalfPi - 2 * asin;
+}
+
+/**
+ * @brief Calculates one distance with the scalar kernel.
+ */
+static inline double distanceScalar(double lat1, double lon1, double lat2, double lon2)
+{
+    double sinLat = sinScalar((lat2 - lat1) * HalfRadians);
+    double sinLon = sinScalar((lon2 - lon1) * HalfRadians);
+    double cos1 = sinScalar(HalfPi - std::fabs(lat1 * 2 * HalfRadians));
+    double cos2 = sinScalar(HalfPi - std::fabs(lat2 * 2 * HalfRadians));
+    double a = sinLat * sinLat + sinLon * sinLon * cos1 * cos2;
+    return 2 * EarthRadius * asinSqrtScalar(a);
+}
+
+/**
+ * @brief Measures a batch with the scalar kernel; with Broadcast, lat1 and lon1 point to a single point.
+ */
+template <bool Broadcast>
+static void batchScalar(const double *lat1, const double *lon1, const double *lat2, const double *lon2, double *distances, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        std::size_t j = Broadcast ? 0 : i;
+        distances[i] = distanceScalar(lat1[j], lon1[j], lat2[i], lon2[i]);
+    }
+}
+
+#ifdef HAVERSINE_X86
+
+__attribute__((target("sse2"), always_inline)) static inline __m128d selectSse2(__m128d mask, __m128d yes, __m128d no)
+{
+    return _mm_or_pd(_mm_and_pd(mask, yes), _mm_andnot_pd(mask, no));
+}
+
+__attribute__((target("sse2"), always_inline)) static inline __m128d sinSse2(__m128d x)
+{
+    x = _mm_andnot_pd(_mm_set1_pd(-0.0), x);
+    x = selectSse2(_mm_cmpgt_pd(x, _mm_set1_pd(HalfPi)), _mm_sub_pd(_mm_set1_pd(Pi), x), x);
+    __m128d z = _mm_mul_pd(x, x);
+    __m128d p = _mm_set1_pd(SinCoefficients[SinTerms - 1]);
+    for (int i = SinTerms - 2; i >= 0; i--)
+    {
+        p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(SinCoefficients[i]));
+    }
+    return _mm_add_pd(x, _mm_mul_pd(_mm_mul_pd(x, z), p));
+}
+
+__attribute__((target("sse2"), always_inline)) static inline __m128d asinSqrtSse2(__m128d a)
+{
+    a = _mm_min_pd(_mm_set1_pd(1.0), a);
+    __m128d s = _mm_sqrt_pd(a);
+    __m128d small = _mm_cmple_pd(a, _mm_set1_pd(0.25));
+    __m128d z = selectSse2(small, a, _mm_mul_pd(_mm_sub_pd(_mm_set1_pd(1.0), s), _mm_set1_pd(0.5)));
+    __m128d x = selectSse2(small, s, _mm_sqrt_pd(z));
+    __m128d p = _mm_set1_pd(AsinCoefficients[AsinTerms - 1]);
+    for (int i = AsinTerms - 2; i >= 0; i--)
+    {
+        p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(AsinCoefficients[i]));
+    }
+    __m128d asin = _mm_add_pd(x, _mm_mul_pd(_mm_mul_pd(x, z), p));
+    return selectSse2(small, asin, _mm_sub_pd(_mm_set1_pd(HalfPi), _mm_add_pd(asin, asin)));
+}
+
+__attribute__((target("sse2"), always_inline)) static inline __m128d distanceSse2(__m128d lat1, __m128d lon1, __m128d lat2, __m128d lon2)
+{
+    __m128d half = _mm_set1_pd(HalfRadians);
+    __m128d sign = _mm_set1_pd(-0.0);
+    __m128d sinLat = sinSse2(_mm_mul_pd(_mm_sub_pd(lat2, lat1), half));
+    __m128d sinLon = sinSse2(_mm_mul_pd(_mm_sub_pd(lon2, lon1), half));
+    __m128d cos1 = sinSse2(_mm_sub_pd(_mm_set1_pd(HalfPi), _mm_andnot_pd(sign, _mm_mul_pd(lat1, _mm_add_pd(half, half)))));
+    __m128d cos2 = sinSse2(_mm_sub_pd(_mm_set1_pd(HalfPi), _mm_andnot_pd(sign, _mm_mul_pd(lat2, _mm_add_pd(half, half)))));
+    __m128d a = _mm_add_pd(_mm_mul_pd(sinLat, sinLat), _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(sinLon, sinLon), cos1), cos2));
+    return _mm_mul_pd(_mm_set1_pd(2 * EarthRadius), asinSqrtSse2(a));
+}
+
+template <bool Broadcast>
+__attribute__((target("sse2"))) static void batchSse2(const double *lat1, const double *lon1, const double *lat2, const double *lon2, double *distances, std::size_t count)
+{
+    const std::size_t Width = 2;
+    __m128d fromLat = _mm_set1_pd(lat1[0]);
+    __m128d fromLon = _mm_set1_pd(lon1[0]);
+    std::size_t i = 0;
+    for (; i + Width <= count; i += Width)
+    {
+        if (!Broadcast)
+        {
+            fromLat = _mm_loadu_pd(lat1 + i);
+            fromLon = _mm_loadu_pd(lon1 + i);
+        }
+        _mm_storeu_pd(distances + i, distanceSse2(fromLat, fromLon, _mm_loadu_pd(lat2 + i), _mm_loadu_pd(lon2 + i)));
+    }
+    if (i < count)
+    {
+        // the last, partial batch is padded out to a full register
+        double tail[4][Width] = {};
+        for (std::size_t j = 0; i + j < count; j++)
+        {
+            tail[0][j] = lat1[Broadcast ? 0 : i + j];
+            tail[1][j] = lon1[Broadcast ? 0 : i + j];
+            tail[2][j] = lat2[i + j];
+            tail[3][j] = lon2[i + j];
+        }
+        double result[Width];
+        _mm_storeu_pd(result, distanceSse2(_mm_loadu_pd(tail[0]), _mm_loadu_pd(tail[1]), _mm_loadu_pd(tail[2]), _mm_loadu_pd(tail[3])));
+        for (std::size_t j = 0; i + j < count; j++)
+        {
+            distances[i + j] = result[j];
+        }
+    }
+}
+
+__attribute__((target("avx2,fma"), always_inline)) static inline __m256d sinAvx2(__m256d x)
+{
+    x = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+    x = _mm256_blendv_pd(x, _mm256_sub_pd(_mm256_set1_pd(Pi), x), _mm256_cmp_pd(x, _mm256_set1_pd(HalfPi), _CMP_GT_OQ));
+    __m256d z = _mm256_mul_pd(x, x);
+    __m256d p = _mm256_set1_pd(SinCoefficients[SinTerms - 1]);
+    for (int i = SinTerms - 2; i >= 0; i--)
+    {
+        p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(SinCoefficients[i]));
+    }
+    return _mm256_fmadd_pd(_mm256_mul_pd(x, z), p, x);
+}
+
+__attribute__((target("avx2,fma"), always_inline)) static inline __m256d asinSqrtAvx2(__m256d a)
+{
+    a = _mm256_min_pd(_mm256_set1_pd(1.0), a);
+    __m256d s = _mm256_sqrt_pd(a);
+    __m256d small = _mm256_cmp_pd(a, _mm256_set1_pd(0.25), _CMP_LE_OQ);
+    __m256d z = _mm256_blendv_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), s), _mm256_set1_pd(0.5)), a, small);
+    __m256d x = _mm256_blendv_pd(_mm256_sqrt_pd(z), s, small);
+    __m256d p = _mm256_set1_pd(AsinCoefficients[AsinTerms - 1]);
+    for (int i = AsinTerms - 2; i >= 0; i--)
+    {
+        p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(AsinCoefficients[i]));
+    }
+    __m256d asin = _mm256_fmadd_pd(_mm256_mul_pd(x, z), p, x);
+    return _mm256_blendv_pd(_mm256_fnmadd_pd(_mm256_set1_pd(2.0), asin, _mm256_set1_pd(HalfPi)), asin, small);
+}
+
+__attribute__((target("avx2,fma"), always_inline)) static inline __m256d distanceAvx2(__m256d lat1, __m256d lon1, __m256d lat2, __m256d lon2)
+{
+    __m256d half = _mm256_set1_pd(HalfRadians);
+    __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d sinLat = sinAvx2(_mm256_mul_pd(_mm256_sub_pd(lat2, lat1), half));
+    __m256d sinLon = sinAvx2(_mm256_mul_pd(_mm256_sub_pd(lon2, lon1), half));
+    __m256d cos1 = sinAvx2(_mm256_sub_pd(_mm256_set1_pd(HalfPi), _mm256_andnot_pd(sign, _mm256_mul_pd(lat1, _mm256_add_pd(half, half)))));
+    __m256d cos2 = sinAvx2(_mm256_sub_pd(_mm256_set1_pd(HalfPi), _mm256_andnot_pd(sign, _mm256_mul_pd(lat2, _mm256_add_pd(half, half)))));
+    __m256d a = _mm256_fmadd_pd(sinLat, sinLat, _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(sinLon, sinLon), cos1), cos2));
+    return _mm256_mul_pd(_mm256_set1_pd(2 * EarthRadius), asinSqrtAvx2(a));
+}
+
+template <bool Broadcast>
+__attribute__((target("avx2,fma"))) static void batchAvx2(const double *lat1, const double *lon1, const double *lat2, const double *lon2, double *distances, std::size_t count)
+{
+    const std::size_t Width = 4;
+    __m256d fromLat = _mm256_set1_pd(lat1[0]);
+    __m256d fromLon = _mm256_set1_pd(lon1[0]);
+    std::size_t i = 0;
+    for (; i + Width <= count; i += Width)
+    {
+        if (!Broadcast)
+        {
+            fromLat = _mm256_loadu_pd(lat1 + i);
+            fromLon = _mm256_loadu_pd(lon1 + i);
+        }
+        _mm256_storeu_pd(distances + i, distanceAvx2(fromLat, fromLon, _mm256_loadu_pd(lat2 + i), _mm256_loadu_pd(lon2 + i)));
+    }
+    if (i < count)
+    {
+        // the last, partial batch is padded out to a full register
+        double tail[4][Width] = {};
+        for (std::size_t j = 0; i + j < count; j++)
+        {
+            tail[0][j] = lat1[Broadcast ? 0 : i + j];
+            tail[1][j] = lon1[Broadcast ? 0 : i + j];
+            tail[2][j] = lat2[i + j];
+            tail[3][j] = lon2[i + j];
+        }
+        double result[Width];
+        _mm256_storeu_pd(result, distanceAvx2(_mm256_loadu_pd(tail[0]), _mm256_loadu_pd(tail[1]), _mm256_loadu_pd(tail[2]), _mm256_loadu_pd(tail[3])));
+        for (std::size_t j = 0; i + j < count; j++)
+        {
+            distances[i + j] = result[j];
+        }
+    }
+}
+
+#endif
+
+/**
+ * @brief Checks whether the processor can run a kernel.
+ */
+static bool supports(HaversineKernel kernel)
+{
+    switch (kernel)
+    {
+#ifdef HAVERSINE_X86
+    case HaversineKernel::Avx2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case HaversineKernel::Sse2:
+        return __builtin_cpu_supports("sse2");
+#endif
+    case HaversineKernel::Scalar:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Picks the fastest kernel the processor supports.
+ */
+static HaversineKernel fastestKernel()
+{
+    if (supports(HaversineKernel::Avx2))
+    {
+        return HaversineKernel::Avx2;
+    }
+    if (supports(HaversineKernel::Sse2))
+    {
+        return HaversineKernel::Sse2;
+    }
+    return HaversineKernel::Scalar;
+}
+
+static std::atomic<HaversineKernel> &currentKernel()
+{
+    static std::atomic<HaversineKernel> kernel(fastestKernel());
+    return kernel;
+}
+
+template <bool Broadcast>
+static void batch(const double *lat1, const double *lon1, const double *lat2, const double *lon2, double *distances, std::size_t count)
+{
+    switch (currentKernel().load(std::memory_order_relaxed))
+    {
+#ifdef HAVERSINE_X86
+    case HaversineKernel::Avx2:
+        batchAvx2<Broadcast>(lat1, lon1, lat2, lon2, distances, count);
+        return;
+    case HaversineKernel::Sse2:
+        batchSse2<Broadcast>(lat1, lon1, lat2, lon2, distances, count);
+        return;
+#endif
+    default:
+        batchScalar<Broadcast>(lat1, lon1, lat2, lon2, distances, count);
+        return;
+    }
+}
+
+/**
+ * @brief Calculates the distances between many pairs of points, given as structure-of-arrays coordinates.
+ *
+ * @param lat1 The latitude of the first point of every pair in degrees.
+ * @param lon1 The longitude of the first point of every pair in degrees.
+ * @param lat2 The latitude of the second point of every pair in degrees.
+ * @param lon2 The longitude of the second point of every pair in degrees.
+ * @param distances Receives the distance of every pair in kilometers.
+ * @param count The number of pairs.
+ */
+void haversineBatch(const double *lat1, const double *lon1, const double *lat2, const double *lon2, double *distances, std::size_t count)
+{
+    batch<false>(lat1, lon1, lat2, lon2, distances, count);
+}
+
+/**
+ * @brief Calculates the distances from one point to many points, given as structure-of-arrays coordinates.
+ *
+ * @param lat The latitude of the point to measure from in degrees.
+ * @param lon The longitude of the point to measure from in degrees.
+ * @param lats The latitude of every point to measure to in degrees.
+ * @param lons The longitude of every point to measure to in degrees.
+ * @param distances Receives the distance to every point in kilometers.
+ * @param count The number of points to measure to.
+ */
+void haversineFrom(double lat, double lon, const double *lats, const double *lons, double *distances, std::size_t count)
+{
+    batch<true>(&lat, &lon, lats, lons, distances, count);
+}
+
+/**
+ * @brief Gets the kernel the batched haversine functions run on.
+ *
+ * @return The kernel in use.
+ */
+HaversineKernel haversineKernel()
+{
+    return currentKernel().load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Forces the batched haversine functions onto a kernel, for example to compare kernels.
+ *
+ * @param kernel The kernel to use.
+ * @return True if the processor supports the kernel and it is now in use, false otherwise.
+ */
+bool useHaversineKernel(HaversineKernel kernel)
+{
+    if (!supports(kernel))
+    {
+        return false;
+    }
+    currentKernel().store(kernel, std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,65 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef HAVERSINE_BATCH_H
+#define HAVERSINE_BATCH_H
+
+#include <cstddef>
+
+/**
+ * @brief The instruction sets the batched haversine functions can run on.
+ */
+enum class HaversineKernel
+{
+    Scalar, /**< Plain double arithmetic, available everywhere. */
+    Sse2,   /**< Two distances at a time with SSE2. */
+    Avx2    /**< Four distances at a time with AVX2 and FMA. */
+};
+
+/**
+ * @brief Calculates the distances between many pairs of points, given as structure-of-arrays coordinates.
+ *
+ * The sines and arcsines are evaluated with polynomials instead of calls into the math library, so every kernel
+ * is plain arithmetic; the results agree with haversine() to about 13 significant digits.
+ * Latitudes must lie within [-90, 90] degrees and longitudes within [-180, 180] degrees. A pair with a NaN
+ * coordinate gets a NaN distance.
+ *
+ * @param lat1 The latitude of the first point of every pair in degrees.
+ * @param lon1 The longitude of the first point of every pair in degrees.
+ * @param lat2 The latitude of the second point of every pair in degrees.
+ * @param lon2 The longitude of the second point of every pair in degrees.
+ * @param distances Receives the distance of every pair in kilometers.
+ * @param count The number of pairs.
+ */
+void haversineBatch(const double *lat1, const double *lon1, const double *lat2, const double *lon2, double *distances, std::size_t count);
+
+/**
+ * @brief Calculates the distances from one point to many points, given as structure-of-arrays coordinates.
+ * Follows the same rules as haversineBatch.
+ *
+ * @param lat The latitude of the point to measure from in degrees.
+ * @param lon The longitude of the point to measure from in degrees.
+ * @param lats The latitude of every point to measure to in degrees.
+ * @param lons The longitude of every point to measure to in degrees.
+ * @param distances Receives the distance to every point in kilometers.
+ * @param count The number of points to measure to.
+ */
+void haversineFrom(double lat, double lon, const double *lats, const double *lons, double *distances, std::size_t count);
+
+/**
+ * @brief Gets the kernel the batched haversine functions run on.
+ * The fastest kernel the processor supports is chosen the first time a batch is measured.
+ *
+ * @return The kernel in use.
+ */
+HaversineKernel haversineKernel();
+
+/**
+ * @brief Forces the batched haversine functions onto a kernel, for example to compare kernels.
+ * Must not be called while a batch is being measured on another thread.
+ *
+ * @param kernel The kernel to use.
+ * @return True if the processor supports the kernel and it is now in use, false otherwise.
+ */
+bool useHaversineKernel(HaversineKernel kernel);
+
+#endif // HAVERSINE_BATCH_H
@@ -0,0 +1,585 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <queue>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include "contraction_hierarchy.h"
+#include "../Iata/iata.h"
+
+/**
+ * @brief The most airports a witness search settles before giving up and adding the shortcut anyway.
+ * A missed witness only costs an unnecessary shortcut, never a wrong answer.
+ */
+static const std::size_t WitnessSettleLimit = 500;
+
+/**
+ * @brief The witness search limit used when only estimating how many shortcuts contracting an airport would add.
+ */
+static const std::size_t SimulationSettleLimit = 50;
+
+/**
+ * @struct HierarchyQueryState
+ * @brief The scratch arrays of a hierarchy query, kept between queries on the same thread and reset through the list
+ * of airports the last query touched.
+ */
+struct HierarchyQueryState
+{
+    std::vector<double> Distances[2]; /**< The tentative distance of every airport from the starts (0) and to the goals (1). */
+    std::vector<std::uint32_t> Parents[2]; /**< The airport every airport was reached from, in each direction. */
+    std::vector<std::uint32_t> Middles[2]; /**< The middle airport of the edge every airport was reached through, in each direction. */
+    std::vector<std::uint32_t> Touched; /**< The airports whose entries the last query changed. */
+};
+
+/**
+ * @brief Default constructor for the ContractionHierarchy class.
+ * Creates an empty hierarchy with no airports.
+ */
+ContractionHierarchy::ContractionHierarchy()
+{
+    this->UpOffsets.push_back(0);
+    this->DownOffsets.push_back(0);
+}
+
+/**
+ * @brief Builds the hierarchy of a route graph.
+ *
+ * Airports are contracted in order of a priority that is recomputed lazily: the number of shortcuts contracting
+ * the airport would add, less the number of edges it would remove, plus the number of its neighbors already
+ * contracted so the contraction spreads evenly over the network. Before a shortcut u -> x around v is added, a
+ * witness search from u looks for another route to x no longer than the one through v. Routes that cannot be
+ * measured are left out.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @return The contraction hierarchy of the graph.
+ */
+ContractionHierarchy ContractionHierarchy::build(const FlightGraph &graph)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::uint32_t airportCount = graph.airportCount();
+
+    // the remaining graph; incoming[x] holds the edges arriving at x, with Target set to the airport they leave
+    std::vector<std::vector<HierarchyEdge>> outgoing(airportCount);
+    std::vector<std::vector<HierarchyEdge>> incoming(airportCount);
+    auto addEdge = [&](std::uint32_t from, std::uint32_t to, double weight, std::uint32_t middle)
+    {
+        for (auto &edge : outgoing[from])
+        {
+            if (edge.Target == to)
+            {
+                if (weight < edge.Weight)
+                {
+                    edge.Weight = weight;
+                    edge.Middle = middle;
+                    for (auto &reverse : incoming[to])
+                    {
+                        if (reverse.Target == from)
+                        {
+                            reverse.Weight = weight;
+                            reverse.Middle = middle;
+                        }
+                    }
+                }
+                return;
+            }
+        }
+        outgoing[from].push_back(HierarchyEdge{to, middle, weight});
+        incoming[to].push_back(HierarchyEdge{from, middle, weight});
+    };
+    for (std::uint32_t source = 0; source < airportCount; source++)
+    {
+        const double *distance = graph.distancesBegin(source);
+        for (const std::uint32_t *destination = graph.successorsBegin(source); destination != graph.successorsEnd(source); destination++, distance++)
+        {
+            if (*destination != source && *distance != infinity)
+            {
+                addEdge(source, *destination, *distance, IataTable::NoId);
+            }
+        }
+    }
+
+    std::vector<char> contracted(airportCount, 0);
+    std::vector<int> contractedNeighbors(airportCount, 0);
+
+    // bounded Dijkstra over the remaining graph, skipping the airport being contracted
+    typedef std::pair<double, std::uint32_t> HeapEntry;
+    std::vector<double> witness(airportCount, infinity);
+    std::vector<std::uint32_t> witnessTouched;
+    auto witnessSearch = [&](std::uint32_t source, std::uint32_t skipped, double limit, std::size_t settleLimit)
+    {
+        for (auto const &id : witnessTouched)
+        {
+            witness[id] = infinity;
+        }
+        witnessTouched.clear();
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+        witness[source] = 0;
+        witnessTouched.push_back(source);
+        heap.emplace(0, source);
+        std::size_t settled = 0;
+        while (!heap.empty())
+        {
+            HeapEntry top = heap.top();
+            heap.pop();
+            if (top.first > witness[top.second])
+            {
+                continue;
+            }
+            if (top.first > limit || ++settled > settleLimit)
+            {
+                break;
+            }
+            for (auto const &edge : outgoing[top.second])
+            {
+                if (contracted[edge.Target] || edge.Target == skipped)
+                {
+                    continue;
+                }
+                double candidate = top.first + edge.Weight;
+                if (candidate <= limit && candidate < witness[edge.Target])
+                {
+                    if (witness[edge.Target] == infinity)
+                    {
+                        witnessTouched.push_back(edge.Target);
+                    }
+                    witness[edge.Target] = candidate;
+                    heap.emplace(candidate, edge.Target);
+                }
+            }
+        }
+    };
+
+    // counts (apply == false) or adds (apply == true) the shortcuts needed to contract an airport
+    auto contract = [&](std::uint32_t airport, bool apply)
+    {
+        int shortcuts = 0;
+        for (std::size_t i = 0; i < incoming[airport].size(); i++)
+        {
+            HierarchyEdge in = incoming[airport][i];
+            if (contracted[in.Target])
+            {
+                continue;
+            }
+            double longestOut = -1;
+            for (auto const &out : outgoing[airport])
+            {
+                if (!contracted[out.Target] && out.Target != in.Target)
+                {
+                    longestOut = std::max(longestOut, out.Weight);
+                }
+            }
+            if (longestOut < 0)
+            {
+                continue;
+            }
+            witnessSearch(in.Target, airport, in.Weight + longestOut, apply ? WitnessSettleLimit : SimulationSettleLimit);
+            for (std::size_t j = 0; j < outgoing[airport].size(); j++)
+            {
+                HierarchyEdge out = outgoing[airport][j];
+                if (contracted[out.Target] || out.Target == in.Target)
+                {
+                    continue;
+                }
+                double via = in.Weight + out.Weight;
+                if (witness[out.Target] > via)
+                {
+                    shortcuts++;
+                    if (apply)
+                    {
+                        addEdge(in.Target, out.Target, via, airport);
+                    }
+                }
+            }
+        }
+        return shortcuts;
+    };
+    auto priority = [&](std::uint32_t airport)
+    {
+        int removed = 0;
+        for (auto const &edge : incoming[airport])
+        {
+            removed += contracted[edge.Target] ? 0 : 1;
+        }
+        for (auto const &edge : outgoing[airport])
+        {
+            removed += contracted[edge.Target] ? 0 : 1;
+        }
+        return contract(airport, false) - removed + contractedNeighbors[airport];
+    };
+
+    typedef std::pair<int, std::uint32_t> OrderEntry;
+    std::priority_queue<OrderEntry, std::vector<OrderEntry>, std::greater<OrderEntry>> order;
+    for (std::uint32_t airport = 0; airport < airportCount; airport++)
+    {
+        order.emplace(priority(airport), airport);
+    }
+
+    ContractionHierarchy hierarchy;
+    hierarchy.Ranks.assign(airportCount, 0);
+    std::uint32_t nextRank = 0;
+    while (!order.empty())
+    {
+        std::uint32_t airport = order.top().second;
+        order.pop();
+        if (contracted[airport])
+        {
+            continue;
+        }
+        // priorities go stale as neighbors are contracted; only contract once the airport is still the cheapest
+        int current = priority(airport);
+        if (!order.empty() && current > order.top().first)
+        {
+            order.emplace(current, airport);
+            continue;
+        }
+
+        contract(airport, true);
+        contracted[airport] = 1;
+        hierarchy.Ranks[airport] = nextRank++;
+        for (auto const &edge : incoming[airport])
+        {
+            contractedNeighbors[edge.Target]++;
+        }
+        for (auto const &edge : outgoing[airport])
+        {
+            contractedNeighbors[edge.Target]++;
+        }
+    }
+
+    // keep every edge in the direction of the higher ranked airport
+    hierarchy.UpOffsets.assign(airportCount + 1, 0);
+    hierarchy.DownOffsets.assign(airportCount + 1, 0);
+    for (std::uint32_t airport = 0; airport < airportCount; airport++)
+    {
+        for (auto const &edge : outgoing[airport])
+        {
+            if (hierarchy.Ranks[edge.Target] > hierarchy.Ranks[airport])
+            {
+                hierarchy.UpEdges.push_back(edge);
+            }
+        }
+        for (auto const &edge : incoming[airport])
+        {
+            if (hierarchy.Ranks[edge.Target] > hierarchy.Ranks[airport])
+            {
+                hierarchy.DownEdges.push_back(edge);
+            }
+        }
+        hierarchy.UpOffsets[airport + 1] = static_cast<std::uint32_t>(hierarchy.UpEdges.size());
+        hierarchy.DownOffsets[airport + 1] = static_cast<std::uint32_t>(hierarchy.DownEdges.size());
+    }
+
+    return hierarchy;
+}
+
+/**
+ * @brief Builds a hierarchy from its arrays, such as the arrays of a saved hierarchy.
+ *
+ * @param ranks The rank of every airport; airportCount entries.
+ * @param airportCount The number of airports in the hierarchy.
+ * @param upOffsets The start of each airport's upward edges; airportCount + 1 entries.
+ * @param upEdges The upward edges; upOffsets[airportCount] entries.
+ * @param downOffsets The start of each airport's downward edges; airportCount + 1 entries.
+ * @param downEdges The downward edges; downOffsets[airportCount] entries.
+ * @return The hierarchy described by the arrays.
+ */
+ContractionHierarchy ContractionHierarchy::fromArrays(const std::uint32_t *ranks, std::uint32_t airportCount, const std::uint32_t *upOffsets, const HierarchyEdge *upEdges,
+                                                      const std::uint32_t *downOffsets, const HierarchyEdge *downEdges)
+{
+    ContractionHierarchy hierarchy;
+    hierarchy.Ranks.assign(ranks, ranks + airportCount);
+    hierarchy.UpOffsets.assign(upOffsets, upOffsets + airportCount + 1);
+    hierarchy.UpEdges.assign(upEdges, upEdges + upOffsets[airportCount]);
+    hierarchy.DownOffsets.assign(downOffsets, downOffsets + airportCount + 1);
+    hierarchy.DownEdges.assign(downEdges, downEdges + downOffsets[airportCount]);
+    return hierarchy;
+}
+
+/**
+ * @brief Gets the rank of every airport.
+ *
+ * @return The ranks, indexed by airport id.
+ */
+const std::vector<std::uint32_t> &ContractionHierarchy::ranks() const
+{
+    return Ranks;
+}
+
+/**
+ * @brief Gets the offsets of the upward edges.
+ *
+ * @return The start of each airport's upward edges; airportCount() + 1 entries.
+ */
+const std::vector<std::uint32_t> &ContractionHierarchy::upOffsets() const
+{
+    return UpOffsets;
+}
+
+/**
+ * @brief Gets the upward edges.
+ *
+ * @return The edges from each airport to higher ranked airports.
+ */
+const std::vector<HierarchyEdge> &ContractionHierarchy::upEdges() const
+{
+    return UpEdges;
+}
+
+/**
+ * @brief Gets the offsets of the downward edges.
+ *
+ * @return The start of each airport's downward edges; airportCount() + 1 entries.
+ */
+const std::vector<std::uint32_t> &ContractionHierarchy::downOffsets() const
+{
+    return DownOffsets;
+}
+
+/**
+ * @brief Gets the downward edges.
+ *
+ * @return The edges into each airport from higher ranked airports.
+ */
+const std::vector<HierarchyEdge> &ContractionHierarchy::downEdges() const
+{
+    return DownEdges;
+}
+
+/**
+ * @brief Gets the number of airports in the hierarchy.
+ *
+ * @return The number of airports, or 0 if the hierarchy has not been built.
+ */
+std::uint32_t ContractionHierarchy::airportCount() const
+{
+    return static_cast<std::uint32_t>(Ranks.size());
+}
+
+/**
+ * @brief Gets the number of shortcuts added while building the hierarchy.
+ *
+ * @return The number of shortcut edges.
+ */
+std::size_t ContractionHierarchy::shortcutCount() const
+{
+    std::size_t shortcuts = 0;
+    for (auto const &edge : UpEdges)
+    {
+        shortcuts += edge.Middle != IataTable::NoId ? 1 : 0;
+    }
+    for (auto const &edge : DownEdges)
+    {
+        shortcuts += edge.Middle != IataTable::NoId ? 1 : 0;
+    }
+    return shortcuts;
+}
+
+/**
+ * @brief Finds an edge of the hierarchy in a CSR array.
+ *
+ * @param offsets The offsets of the array.
+ * @param edges The edges of the array.
+ * @param lower The lower ranked end of the edge.
+ * @param higher The higher ranked end of the edge.
+ * @return The edge.
+ */
+const HierarchyEdge &ContractionHierarchy::findEdge(const std::vector<std::uint32_t> &offsets, const std::vector<HierarchyEdge> &edges, std::uint32_t lower, std::uint32_t higher)
+{
+    std::uint32_t edge = offsets[lower];
+    while (edges[edge].Target != higher)
+    {
+        edge++;
+    }
+    return edges[edge];
+}
+
+/**
+ * @brief Replaces an edge of a route found in the hierarchy with the original routes it stands for.
+ *
+ * A shortcut from -> to around middle stands for the edges from -> middle and middle -> to. The middle airport
+ * was contracted before both ends, so the first is a downward edge into middle and the second an upward edge out
+ * of it; either may be a shortcut itself.
+ *
+ * @param from The airport the edge leaves.
+ * @param to The airport the edge arrives at.
+ * @param middle The middle airport of the edge, or IataTable::NoId for an original route.
+ * @param path Receives the airports after from, up to and including to.
+ */
+void ContractionHierarchy::unpackEdge(std::uint32_t from, std::uint32_t to, std::uint32_t middle, std::vector<std::uint32_t> &path) const
+{
+    if (middle == IataTable::NoId)
+    {
+        path.push_back(to);
+        return;
+    }
+    unpackEdge(from, middle, findEdge(DownOffsets, DownEdges, middle, from).Middle, path);
+    unpackEdge(middle, to, findEdge(UpOffsets, UpEdges, middle, to).Middle, path);
+}
+
+/**
+ * @brief Finds the route with the smallest total great-circle distance.
+ *
+ * @param start The id of the start airport.
+ * @param goal The id of the goal airport.
+ * @return The shortest route with every shortcut unpacked into the routes it stands for, or an empty result if the
+ * goal cannot be reached.
+ */
+SearchResult ContractionHierarchy::shortestRoute(std::uint32_t start, std::uint32_t goal) const
+{
+    return shortestRoute(std::vector<std::uint32_t>(1, start), std::vector<std::uint32_t>(1, goal));
+}
+
+/**
+ * @brief Finds the shortest route from any of several start airports to any of several goal airports, in a single query.
+ *
+ * Two Dijkstra searches run in turn, forwards from every start over upward edges and backwards from every goal
+ * over downward edges, each seeded with all of its airports at distance 0. Each airport settled by both searches
+ * is a candidate meeting point; a search stops once the nearest airport left on its heap is no closer than the
+ * best route found so far. An airport that a higher airport already reached can reach more cheaply is stalled:
+ * it is not expanded, which keeps both searches small. The edges from the start to the meeting point and from
+ * the meeting point to the goal are then unpacked into original routes.
+ *
+ * @param starts The ids of the airports the route may start at.
+ * @param goals The ids of the airports the route may end at.
+ * @return The shortest route with every shortcut unpacked into the routes it stands for, or an empty result if no
+ * goal can be reached.
+ */
+SearchResult ContractionHierarchy::shortestRoute(const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals) const
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    SearchResult result;
+
+    static thread_local HierarchyQueryState state;
+    if (state.Distances[0].size() != airportCount())
+    {
+        for (int direction = 0; direction < 2; direction++)
+        {
+            state.Distances[direction].assign(airportCount(), infinity);
+            state.Parents[direction].assign(airportCount(), IataTable::NoId);
+            state.Middles[direction].assign(airportCount(), IataTable::NoId);
+        }
+        state.Touched.clear();
+    }
+    for (auto const &id : state.Touched)
+    {
+        for (int direction = 0; direction < 2; direction++)
+        {
+            state.Distances[direction][id] = infinity;
+            state.Parents[direction][id] = IataTable::NoId;
+        }
+    }
+    state.Touched.clear();
+
+    typedef std::pair<double, std::uint32_t> HeapEntry;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heaps[2];
+    const std::vector<std::uint32_t> *offsets[2] = {&UpOffsets, &DownOffsets};
+    const std::vector<HierarchyEdge> *edges[2] = {&UpEdges, &DownEdges};
+    // ids that are not in the hierarchy (such as IataTable::NoId for unknown airports) are ignored
+    const std::vector<std::uint32_t> *ends[2] = {&starts, &goals};
+    for (int direction = 0; direction < 2; direction++)
+    {
+        for (auto const &end : *ends[direction])
+        {
+            if (end < airportCount() && state.Parents[direction][end] == IataTable::NoId)
+            {
+                state.Distances[direction][end] = 0;
+                state.Parents[direction][end] = end;
+                state.Touched.push_back(end);
+                heaps[direction].emplace(0, end);
+            }
+        }
+    }
+
+    double best = infinity;
+    std::uint32_t meeting = IataTable::NoId;
+    while (!heaps[0].empty() || !heaps[1].empty())
+    {
+        for (int direction = 0; direction < 2; direction++)
+        {
+            std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> &heap = heaps[direction];
+            if (heap.empty())
+            {
+                continue;
+            }
+            HeapEntry top = heap.top();
+            if (top.first >= best)
+            {
+                heap = std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>>();
+                continue;
+            }
+            heap.pop();
+            std::uint32_t airport = top.second;
+            if (top.first > state.Distances[direction][airport])
+            {
+                continue;
+            }
+            result.Expanded++;
+
+            double total = top.first + state.Distances[1 - direction][airport];
+            if (total < best)
+            {
+                best = total;
+                meeting = airport;
+            }
+
+            // stall on demand: an airport reached more cheaply through a higher airport cannot lie on a shortest up-down route
+            bool stalled = false;
+            for (std::uint32_t e = (*offsets[1 - direction])[airport]; e < (*offsets[1 - direction])[airport + 1] && !stalled; e++)
+            {
+                const HierarchyEdge &edge = (*edges[1 - direction])[e];
+                stalled = state.Distances[direction][edge.Target] + edge.Weight < top.first;
+            }
+            if (stalled)
+            {
+                continue;
+            }
+
+            for (std::uint32_t e = (*offsets[direction])[airport]; e < (*offsets[direction])[airport + 1]; e++)
+            {
+                const HierarchyEdge &edge = (*edges[direction])[e];
+                double candidate = top.first + edge.Weight;
+                if (candidate < state.Distances[direction][edge.Target])
+                {
+                    if (state.Parents[0][edge.Target] == IataTable::NoId && state.Parents[1][edge.Target] == IataTable::NoId)
+                    {
+                        state.Touched.push_back(edge.Target);
+                    }
+                    state.Distances[direction][edge.Target] = candidate;
+                    state.Parents[direction][edge.Target] = airport;
+                    state.Middles[direction][edge.Target] = edge.Middle;
+                    heap.emplace(candidate, edge.Target);
+                }
+            }
+        }
+    }
+
+    if (meeting == IataTable::NoId)
+    {
+        return result;
+    }
+
+    // the forward half is stored from the meeting point back to its start, so collect it before unpacking;
+    // start and goal airports are their own parents
+    std::vector<std::uint32_t> upward;
+    std::uint32_t from = meeting;
+    while (state.Parents[0][from] != from)
+    {
+        upward.push_back(from);
+        from = state.Parents[0][from];
+    }
+    result.Path.push_back(from);
+    for (auto it = upward.rbegin(); it != upward.rend(); it++)
+    {
+        unpackEdge(from, *it, state.Middles[0][*it], result.Path);
+        from = *it;
+    }
+    for (std::uint32_t airport = meeting; state.Parents[1][airport] != airport; airport = state.Parents[1][airport])
+    {
+        unpackEdge(airport, state.Parents[1][airport], state.Middles[1][airport], result.Path);
+    }
+    result.Distance = best;
+    return result;
+}
@@ -0,0 +1,167 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../Graph/flight_graph.h"
+#include "../Search/route_search.h"
+
+/**
+ * @struct HierarchyEdge
+ * @brief One edge of a contraction hierarchy: an original route, or a shortcut standing for two edges through a lower airport.
+ */
+struct HierarchyEdge
+{
+    std::uint32_t Target; /**< The id of the higher ranked airport at the other end of the edge. */
+    std::uint32_t Middle; /**< The airport the shortcut was added around, or IataTable::NoId for an original route. */
+    double Weight; /**< The great-circle length of the edge in kilometers. */
+};
+
+/**
+ * @class ContractionHierarchy
+ * @brief A preprocessed form of the route graph that answers shortest distance queries in microseconds.
+ *
+ * Airports are contracted one by one, least important first. Contracting an airport removes it from the remaining
+ * graph and adds a shortcut between two of its neighbors wherever the route through it was the only shortest
+ * route between them. Each airport's rank is the order it was contracted in. A query then only has to search
+ * upwards, towards more important airports, from both ends of the trip; the two searches meet at the most
+ * important airport of the shortest route.
+ *
+ * The edges are kept in two CSR arrays indexed by the lower ranked end: upward edges leaving each airport, and
+ * downward edges arriving at each airport (stored by the airport they come from), so the backward search can
+ * walk them upwards as well.
+ */
+class ContractionHierarchy
+{
+
+private:
+    std::vector<std::uint32_t> Ranks; /**< The contraction order of every airport; higher is more important. */
+    std::vector<std::uint32_t> UpOffsets; /**< Start of each airport's upward edges in UpEdges; airportCount() + 1 entries. */
+    std::vector<HierarchyEdge> UpEdges; /**< Edges from each airport to higher ranked airports. */
+    std::vector<std::uint32_t> DownOffsets; /**< Start of each airport's downward edges in DownEdges; airportCount() + 1 entries. */
+    std::vector<HierarchyEdge> DownEdges; /**< Edges into each airport from higher ranked airports, keyed by the airport they leave. */
+
+    /**
+     * @brief Finds an edge of the hierarchy in a CSR array.
+     *
+     * @param offsets The offsets of the array.
+     * @param edges The edges of the array.
+     * @param lower The lower ranked end of the edge.
+     * @param higher The higher ranked end of the edge.
+     * @return The edge.
+     */
+    static const HierarchyEdge &findEdge(const std::vector<std::uint32_t> &offsets, const std::vector<HierarchyEdge> &edges, std::uint32_t lower, std::uint32_t higher);
+
+    /**
+     * @brief Replaces an edge of a route found in the hierarchy with the original routes it stands for.
+     *
+     * @param from The airport the edge leaves.
+     * @param to The airport the edge arrives at.
+     * @param middle The middle airport of the edge, or IataTable::NoId for an original route.
+     * @param path Receives the airports after from, up to and including to.
+     */
+    void unpackEdge(std::uint32_t from, std::uint32_t to, std::uint32_t middle, std::vector<std::uint32_t> &path) const;
+
+public:
+    /**
+     * @brief Default constructor for the ContractionHierarchy class.
+     * Creates an empty hierarchy with no airports.
+     */
+    ContractionHierarchy();
+
+    /**
+     * @brief Builds the hierarchy of a route graph.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @return The contraction hierarchy of the graph.
+     */
+    static ContractionHierarchy build(const FlightGraph &graph);
+
+    /**
+     * @brief Builds a hierarchy from its arrays, such as the arrays of a saved hierarchy.
+     *
+     * @param ranks The rank of every airport; airportCount entries.
+     * @param airportCount The number of airports in the hierarchy.
+     * @param upOffsets The start of each airport's upward edges; airportCount + 1 entries.
+     * @param upEdges The upward edges; upOffsets[airportCount] entries.
+     * @param downOffsets The start of each airport's downward edges; airportCount + 1 entries.
+     * @param downEdges The downward edges; downOffsets[airportCount] entries.
+     * @return The hierarchy described by the arrays.
+     */
+    static ContractionHierarchy fromArrays(const std::uint32_t *ranks, std::uint32_t airportCount, const std::uint32_t *upOffsets, const HierarchyEdge *upEdges,
+                                           const std::uint32_t *downOffsets, const HierarchyEdge *downEdges);
+
+    /**
+     * @brief Gets the rank of every airport.
+     *
+     * @return The ranks, indexed by airport id.
+     */
+    const std::vector<std::uint32_t> &ranks() const;
+
+    /**
+     * @brief Gets the offsets of the upward edges.
+     *
+     * @return The start of each airport's upward edges; airportCount() + 1 entries.
+     */
+    const std::vector<std::uint32_t> &upOffsets() const;
+
+    /**
+     * @brief Gets the upward edges.
+     *
+     * @return The edges from each airport to higher ranked airports.
+     */
+    const std::vector<HierarchyEdge> &upEdges() const;
+
+    /**
+     * @brief Gets the offsets of the downward edges.
+     *
+     * @return The start of each airport's downward edges; airportCount() + 1 entries.
+     */
+    const std::vector<std::uint32_t> &downOffsets() const;
+
+    /**
+     * @brief Gets the downward edges.
+     *
+     * @return The edges into each airport from higher ranked airports.
+     */
+    const std::vector<HierarchyEdge> &downEdges() const;
+
+    /**
+     * @brief Gets the number of airports in the hierarchy.
+     *
+     * @return The number of airports, or 0 if the hierarchy has not been built.
+     */
+    std::uint32_t airportCount() const;
+
+    /**
+     * @brief Gets the number of shortcuts added while building the hierarchy.
+     *
+     * @return The number of shortcut edges.
+     */
+    std::size_t shortcutCount() const;
+
+    /**
+     * @brief Finds the route with the smallest total great-circle distance.
+     *
+     * @param start The id of the start airport.
+     * @param goal The id of the goal airport.
+     * @return The shortest route with every shortcut unpacked into the routes it stands for, or an empty result if the
+     * goal cannot be reached.
+     */
+    SearchResult shortestRoute(std::uint32_t start, std::uint32_t goal) const;
+
+    /**
+     * @brief Finds the shortest route from any of several start airports to any of several goal airports, in a single query.
+     *
+     * @param starts The ids of the airports the route may start at.
+     * @param goals The ids of the airports the route may end at.
+     * @return The shortest route with every shortcut unpacked into the routes it stands for, or an empty result if no
+     * goal can be reached.
+     */
+    SearchResult shortestRoute(const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals) const;
+};
+
+#endif // CONTRACTION_HIERARCHY_H
@@ -0,0 +1,171 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "iata.h"
+
+/**
+ * @brief Default constructor for the IataCode class.
+ * Creates an invalid code.
+ */
+IataCode::IataCode()
+{
+    this->Packed = 0;
+}
+
+/**
+ * @brief Packs a code from a sequence of characters.
+ *
+ * @param data The first character of the code.
+ * @param length The number of characters in the code.
+ * @return The packed code, or an invalid code if the characters are not a valid code.
+ */
+IataCode IataCode::fromChars(const char *data, std::size_t length)
+{
+    IataCode code;
+    if (length == 0 || length > 3)
+    {
+        return code;
+    }
+
+    std::uint32_t packed = 0;
+    for (std::size_t i = 0; i < 3; i++)
+    {
+        char c = i < length ? data[i] : '\0';
+        if (i < length && !((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')))
+        {
+            return code;
+        }
+        packed = (packed << 8) | static_cast<unsigned char>(c);
+    }
+    code.Packed = packed;
+    return code;
+}
+
+/**
+ * @brief Packs a code from a string.
+ *
+ * @param code The code as a string, e.g. "ACC".
+ * @return The packed code, or an invalid code if the string is not a valid code.
+ */
+IataCode IataCode::fromString(const std::string &code)
+{
+    return fromChars(code.data(), code.size());
+}
+
+/**
+ * @brief Rebuilds a code from its packed integer form.
+ *
+ * @param packed A value returned by packed().
+ * @return The code.
+ */
+IataCode IataCode::fromPacked(std::uint32_t packed)
+{
+    IataCode code;
+    code.Packed = packed;
+    return code;
+}
+
+/**
+ * @brief Checks whether the code holds a valid code.
+ *
+ * @return True if the code is valid, false otherwise.
+ */
+bool IataCode::isValid() const
+{
+    return Packed != 0;
+}
+
+/**
+ * @brief Gets the packed integer form of the code.
+ *
+ * @return The packed code.
+ */
+std::uint32_t IataCode::packed() const
+{
+    return Packed;
+}
+
+/**
+ * @brief Converts the code back to a string.
+ *
+ * @return The code as a string, or an empty string for an invalid code.
+ */
+std::string IataCode::toString() const
+{
+    std::string code;
+    for (int shift = 16; shift >= 0; shift -= 8)
+    {
+        char c = static_cast<char>((Packed >> shift) & 0xFF);
+        if (c != '\0')
+        {
+            code.push_back(c);
+        }
+    }
+    return code;
+}
+
+const std::uint32_t IataTable::NoId = UINT32_MAX;
+
+/**
+ * @brief Interns a code.
+ *
+ * @param code The code to intern.
+ * @return The id of the code; a new id if the code has not been seen before.
+ */
+std::uint32_t IataTable::intern(IataCode code)
+{
+    auto inserted = Ids.emplace(code, static_cast<std::uint32_t>(Codes.size()));
+    if (inserted.second)
+    {
+        Codes.push_back(code);
+    }
+    return inserted.first->second;
+}
+
+/**
+ * @brief Looks up the id of a code without interning it.
+ *
+ * @param code The code to look up.
+ * @return The id of the code, or NoId if the code has not been interned.
+ */
+std::uint32_t IataTable::find(IataCode code) const
+{
+    auto it = Ids.find(code);
+    if (it == Ids.end())
+    {
+        return NoId;
+    }
+    return it->second;
+}
+
+/**
+ * @brief Looks up the code of an id.
+ *
+ * @param id The id to look up.
+ * @return The code with the given id.
+ */
+IataCode IataTable::code(std::uint32_t id) const
+{
+    return Codes[id];
+}
+
+/**
+ * @brief Gets the number of interned codes.
+ *
+ * @return The number of interned codes, which is also one more than the largest id.
+ */
+std::uint32_t IataTable::size() const
+{
+    return static_cast<std::uint32_t>(Codes.size());
+}
+
+/**
+ * @brief Removes every interned code.
+ */
+void IataTable::clear()
+{
+    Codes.clear();
+    Ids.clear();
+}
@@ -0,0 +1,166 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef IATA_H
+#define IATA_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+
+/**
+ * @class IataCode
+ * @brief A compact, fixed-width airport or airline code.
+ *
+ * Up to three characters are packed into a single 32 bit integer, first character in the highest byte, so codes
+ * can be copied, compared and hashed as plain integers. Packed codes order the same way as the strings they
+ * came from. Codes with no characters, more than three characters, or characters other than letters and digits
+ * (such as the "\N" placeholder in the data files) are invalid.
+ */
+class IataCode
+{
+
+private:
+    std::uint32_t Packed; /**< The packed characters of the code, or 0 for an invalid code. */
+
+public:
+    /**
+     * @brief Default constructor for the IataCode class.
+     * Creates an invalid code.
+     */
+    IataCode();
+
+    /**
+     * @brief Packs a code from a sequence of characters.
+     *
+     * @param data The first character of the code.
+     * @param length The number of characters in the code.
+     * @return The packed code, or an invalid code if the characters are not a valid code.
+     */
+    static IataCode fromChars(const char *data, std::size_t length);
+
+    /**
+     * @brief Packs a code from a string.
+     *
+     * @param code The code as a string, e.g. "ACC".
+     * @return The packed code, or an invalid code if the string is not a valid code.
+     */
+    static IataCode fromString(const std::string &code);
+
+    /**
+     * @brief Rebuilds a code from its packed integer form.
+     *
+     * @param packed A value returned by packed().
+     * @return The code.
+     */
+    static IataCode fromPacked(std::uint32_t packed);
+
+    /**
+     * @brief Checks whether the code holds a valid code.
+     *
+     * @return True if the code is valid, false otherwise.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Gets the packed integer form of the code.
+     *
+     * @return The packed code.
+     */
+    std::uint32_t packed() const;
+
+    /**
+     * @brief Converts the code back to a string.
+     *
+     * @return The code as a string, or an empty string for an invalid code.
+     */
+    std::string toString() const;
+
+    /**
+     * @brief Compares two codes for equality.
+     */
+    bool operator==(const IataCode &other) const { return Packed == other.Packed; }
+
+    /**
+     * @brief Compares two codes for inequality.
+     */
+    bool operator!=(const IataCode &other) const { return Packed != other.Packed; }
+
+    /**
+     * @brief Orders codes the same way as the strings they were packed from.
+     */
+    bool operator<(const IataCode &other) const { return Packed < other.Packed; }
+};
+
+namespace std
+{
+    template <>
+    struct hash<IataCode>
+    {
+        std::size_t operator()(const IataCode &code) const noexcept
+        {
+            return std::hash<std::uint32_t>()(code.packed());
+        }
+    };
+}
+
+/**
+ * @class IataTable
+ * @brief Interns codes and numbers them with dense ids.
+ *
+ * The first code interned gets id 0, the next new code id 1, and so on, so per-airport data can be kept in plain
+ * arrays indexed by id.
+ */
+class IataTable
+{
+
+private:
+    std::vector<IataCode> Codes; /**< The code of each id. */
+    std::unordered_map<IataCode, std::uint32_t> Ids; /**< The id of each interned code. */
+
+public:
+    /**
+     * @brief The id returned for codes that have not been interned.
+     */
+    static const std::uint32_t NoId;
+
+    /**
+     * @brief Interns a code.
+     *
+     * @param code The code to intern.
+     * @return The id of the code; a new id if the code has not been seen before.
+     */
+    std::uint32_t intern(IataCode code);
+
+    /**
+     * @brief Looks up the id of a code without interning it.
+     *
+     * @param code The code to look up.
+     * @return The id of the code, or NoId if the code has not been interned.
+     */
+    std::uint32_t find(IataCode code) const;
+
+    /**
+     * @brief Looks up the code of an id.
+     *
+     * @param id The id to look up.
+     * @return The code with the given id.
+     */
+    IataCode code(std::uint32_t id) const;
+
+    /**
+     * @brief Gets the number of interned codes.
+     *
+     * @return The number of interned codes, which is also one more than the largest id.
+     */
+    std::uint32_t size() const;
+
+    /**
+     * @brief Removes every interned code.
+     */
+    void clear();
+};
+
+#endif // IATA_H
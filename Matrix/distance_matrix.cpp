@@ -0,0 +1,283 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <queue>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include "distance_matrix.h"
+#include "../ThreadPool/thread_pool.h"
+
+const std::uint32_t DistanceMatrix::FormatVersion = 1;
+const std::uint8_t DistanceMatrix::NoHops = UINT8_MAX;
+const std::uint16_t DistanceMatrix::NoDistance = UINT16_MAX;
+
+/**
+ * @brief The number of source airports searched by one task of the thread pool.
+ */
+static const std::uint32_t SourcesPerTask = 64;
+
+/**
+ * @brief Default constructor for the DistanceMatrix class.
+ * Creates a matrix with no file open.
+ */
+DistanceMatrix::DistanceMatrix()
+{
+    this->AirportCount = 0;
+    this->Hops = nullptr;
+    this->Distances = nullptr;
+}
+
+/**
+ * @brief Computes a checksum of the structure of a route graph.
+ * An FNV-1a hash of the graph's offsets and neighbors, so any added, removed or renumbered route changes it.
+ *
+ * @param graph The route graph.
+ * @return The checksum.
+ */
+std::uint64_t DistanceMatrix::checksum(const FlightGraph &graph)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](const std::vector<std::uint32_t> &values)
+    {
+        for (std::uint32_t value : values)
+        {
+            hash = (hash ^ value) * 1099511628211ULL;
+        }
+    };
+    add(graph.offsets());
+    add(graph.neighbors());
+    return hash;
+}
+
+/**
+ * @brief Fills one row of both sections with the results of the searches from one airport.
+ *
+ * Hops come from a breadth-first search over every route; distances from a Dijkstra search over the measured
+ * routes, rounded to whole kilometers and capped just below NoDistance.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param source The id of the airport to search from.
+ * @param hops Receives the fewest flights to every airport.
+ * @param distances Receives the shortest route length to every airport.
+ * @param queue Scratch space for the breadth-first search; resized as needed.
+ * @param lengths Scratch space for the Dijkstra search; resized as needed.
+ */
+void DistanceMatrix::searchFrom(const FlightGraph &graph, std::uint32_t source, std::uint8_t *hops, std::uint16_t *distances, std::vector<std::uint32_t> &queue, std::vector<double> &lengths)
+{
+    std::uint32_t airportCount = graph.airportCount();
+
+    // breadth-first search, using the hops row itself to mark visited airports
+    std::fill(hops, hops + airportCount, NoHops);
+    queue.resize(airportCount);
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    hops[source] = 0;
+    queue[tail++] = source;
+    while (head < tail)
+    {
+        std::uint32_t parent = queue[head++];
+        if (hops[parent] + 1 >= NoHops)
+        {
+            continue;
+        }
+        for (const std::uint32_t *child = graph.successorsBegin(parent); child != graph.successorsEnd(parent); child++)
+        {
+            if (hops[*child] == NoHops)
+            {
+                hops[*child] = static_cast<std::uint8_t>(hops[parent] + 1);
+                queue[tail++] = *child;
+            }
+        }
+    }
+
+    // Dijkstra's algorithm with lazy deletion
+    typedef std::pair<double, std::uint32_t> HeapEntry;
+    lengths.assign(airportCount, std::numeric_limits<double>::infinity());
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+    lengths[source] = 0;
+    heap.emplace(0.0, source);
+    while (!heap.empty())
+    {
+        HeapEntry top = heap.top();
+        heap.pop();
+        std::uint32_t parent = top.second;
+        if (top.first > lengths[parent])
+        {
+            continue;
+        }
+        const double *distance = graph.distancesBegin(parent);
+        for (const std::uint32_t *child = graph.successorsBegin(parent); child != graph.successorsEnd(parent); child++, distance++)
+        {
+            double candidate = top.first + *distance;
+            if (candidate < lengths[*child])
+            {
+                lengths[*child] = candidate;
+                heap.emplace(candidate, *child);
+            }
+        }
+    }
+    for (std::uint32_t id = 0; id < airportCount; id++)
+    {
+        double rounded = std::round(lengths[id]);
+        distances[id] = std::isinf(rounded) ? NoDistance : static_cast<std::uint16_t>(std::min(rounded, NoDistance - 1.0));
+    }
+}
+
+/**
+ * @brief Computes the matrix of a route graph and writes it to a file.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param filename The name of the file to write.
+ * @param threads The number of threads to search with, or 0 to use every hardware thread.
+ * @return True if the file was written, false otherwise.
+ */
+bool DistanceMatrix::compute(const FlightGraph &graph, const std::string &filename, unsigned threads)
+{
+    std::uint32_t airportCount = graph.airportCount();
+    std::size_t cells = static_cast<std::size_t>(airportCount) * airportCount;
+    std::vector<std::uint8_t> hops(cells);
+    std::vector<std::uint16_t> distances(cells);
+
+    // each task searches from a block of sources and writes only their rows
+    {
+        ThreadPool pool(threads);
+        for (std::uint32_t first = 0; first < airportCount; first += SourcesPerTask)
+        {
+            pool.submit([&graph, &hops, &distances, first, airportCount]()
+                        {
+                            std::vector<std::uint32_t> queue;
+                            std::vector<double> lengths;
+                            std::uint32_t last = std::min(airportCount, first + SourcesPerTask);
+                            for (std::uint32_t source = first; source < last; source++)
+                            {
+                                std::size_t row = static_cast<std::size_t>(source) * airportCount;
+                                searchFrom(graph, source, hops.data() + row, distances.data() + row, queue, lengths);
+                            } });
+        }
+        pool.wait();
+    }
+    std::cout << "> Distance matrix computed..." << std::endl;
+
+    MatrixHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, "AEROMAT", 8);
+    header.Version = FormatVersion;
+    header.AirportCount = airportCount;
+    header.GraphChecksum = checksum(graph);
+    header.HopsOffset = (sizeof(header) + 7) / 8 * 8;
+    header.DistancesOffset = (header.HopsOffset + cells + 7) / 8 * 8;
+
+    std::string temporary_filename = filename + ".tmp";
+    std::ofstream outputStream(temporary_filename, std::ios::binary | std::ios::trunc);
+    const char padding[8] = {};
+    outputStream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    outputStream.write(padding, static_cast<std::streamsize>(header.HopsOffset - sizeof(header)));
+    outputStream.write(reinterpret_cast<const char *>(hops.data()), static_cast<std::streamsize>(cells));
+    outputStream.write(padding, static_cast<std::streamsize>(header.DistancesOffset - header.HopsOffset - cells));
+    outputStream.write(reinterpret_cast<const char *>(distances.data()), static_cast<std::streamsize>(cells * sizeof(std::uint16_t)));
+    outputStream.close();
+    if (!outputStream || std::rename(temporary_filename.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(temporary_filename.c_str());
+        std::cout << "error writing distance matrix: check that the matrix directory is writable" << std::endl;
+        return false;
+    }
+
+    std::cout << "> Distance matrix written..." << std::endl;
+    return true;
+}
+
+/**
+ * @brief Maps a matrix file, if it was computed from the given route graph.
+ *
+ * @param filename The name of the file to map.
+ * @param graph The route graph the matrix must have been computed from.
+ * @return True if the file was mapped, false if it is missing, damaged, of another format version or stale.
+ */
+bool DistanceMatrix::open(const std::string &filename, const FlightGraph &graph)
+{
+    AirportCount = 0;
+    Hops = nullptr;
+    Distances = nullptr;
+    if (!File.open(filename))
+    {
+        return false;
+    }
+
+    MatrixHeader header;
+    if (File.size() < sizeof(header))
+    {
+        File.close();
+        return false;
+    }
+    memcpy(&header, File.data(), sizeof(header));
+
+    std::size_t cells = static_cast<std::size_t>(header.AirportCount) * header.AirportCount;
+    if (memcmp(header.Magic, "AEROMAT", 8) != 0 || header.Version != FormatVersion ||
+        header.AirportCount != graph.airportCount() || header.GraphChecksum != checksum(graph) ||
+        header.HopsOffset % 8 != 0 || header.HopsOffset > File.size() || cells > File.size() - header.HopsOffset ||
+        header.DistancesOffset % 8 != 0 || header.DistancesOffset > File.size() ||
+        cells * sizeof(std::uint16_t) > File.size() - header.DistancesOffset)
+    {
+        File.close();
+        return false;
+    }
+
+    AirportCount = header.AirportCount;
+    Hops = reinterpret_cast<const std::uint8_t *>(File.data() + header.HopsOffset);
+    Distances = reinterpret_cast<const std::uint16_t *>(File.data() + header.DistancesOffset);
+    std::cout << "> Distance matrix loaded..." << std::endl;
+    return true;
+}
+
+/**
+ * @brief Checks whether a matrix file is open.
+ *
+ * @return True if a matrix file is open, false otherwise.
+ */
+bool DistanceMatrix::isOpen() const
+{
+    return AirportCount > 0;
+}
+
+/**
+ * @brief Gets the number of airports of the open matrix.
+ *
+ * @return The number of airports, or 0 if no file is open.
+ */
+std::uint32_t DistanceMatrix::airportCount() const
+{
+    return AirportCount;
+}
+
+/**
+ * @brief Looks up the fewest flights from one airport to another.
+ *
+ * @param from The id of the start airport.
+ * @param to The id of the goal airport.
+ * @return The number of flights, or NoHops if the goal cannot be reached.
+ */
+std::uint8_t DistanceMatrix::hops(std::uint32_t from, std::uint32_t to) const
+{
+    return Hops[static_cast<std::size_t>(from) * AirportCount + to];
+}
+
+/**
+ * @brief Looks up the length of the shortest route from one airport to another.
+ *
+ * @param from The id of the start airport.
+ * @param to The id of the goal airport.
+ * @return The length in whole kilometers, or NoDistance if no measurable route reaches the goal.
+ */
+std::uint16_t DistanceMatrix::distance(std::uint32_t from, std::uint32_t to) const
+{
+    return Distances[static_cast<std::size_t>(from) * AirportCount + to];
+}
@@ -0,0 +1,151 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../Graph/flight_graph.h"
+#include "../Mmap/mapped_file.h"
+
+/**
+ * @struct MatrixHeader
+ * @brief The fixed-size header at the start of a distance matrix file.
+ *
+ * The header is followed by two sections, each starting at an 8 byte aligned offset:
+ * - Hops: the fewest flights from every airport to every airport (uint8 x AirportCount x AirportCount, row major).
+ * - Distances: the length of the shortest route from every airport to every airport, rounded to whole kilometers
+ *   (uint16 x AirportCount x AirportCount, row major).
+ *
+ * All values are stored in the byte order of the machine that wrote the file.
+ */
+struct MatrixHeader
+{
+    char Magic[8]; /**< Always "AEROMAT" followed by a NUL. */
+    std::uint32_t Version; /**< The format version the file was written with. */
+    std::uint32_t AirportCount; /**< The number of airports, and the number of rows and columns of each section. */
+    std::uint64_t GraphChecksum; /**< A checksum of the route graph the matrix was computed from. */
+    std::uint64_t HopsOffset; /**< The byte offset of the hops section. */
+    std::uint64_t DistancesOffset; /**< The byte offset of the distances section. */
+};
+
+/**
+ * @class DistanceMatrix
+ * @brief The fewest flights and the shortest route length between every pair of airports, precomputed offline.
+ *
+ * compute runs one breadth-first search and one Dijkstra search from every airport of the route graph, spread over
+ * a thread pool, and writes the results to a file. open maps such a file into memory, after which looking up a pair of
+ * airports is a single array read. A file is only opened for the route graph it was computed from.
+ */
+class DistanceMatrix
+{
+
+private:
+    MappedFile File; /**< The mapped matrix file. */
+    std::uint32_t AirportCount; /**< The number of airports, or 0 if no file is open. */
+    const std::uint8_t *Hops; /**< The hops section of the mapped file. */
+    const std::uint16_t *Distances; /**< The distances section of the mapped file. */
+
+    /**
+     * @brief Computes a checksum of the structure of a route graph.
+     *
+     * @param graph The route graph.
+     * @return The checksum.
+     */
+    static std::uint64_t checksum(const FlightGraph &graph);
+
+    /**
+     * @brief Fills one row of both sections with the results of the searches from one airport.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param source The id of the airport to search from.
+     * @param hops Receives the fewest flights to every airport.
+     * @param distances Receives the shortest route length to every airport.
+     * @param queue Scratch space for the breadth-first search; resized as needed.
+     * @param lengths Scratch space for the Dijkstra search; resized as needed.
+     */
+    static void searchFrom(const FlightGraph &graph, std::uint32_t source, std::uint8_t *hops, std::uint16_t *distances, std::vector<std::uint32_t> &queue, std::vector<double> &lengths);
+
+public:
+    /**
+     * @brief The format version written by this version of the program. Files of other versions are not opened.
+     */
+    static const std::uint32_t FormatVersion;
+
+    /**
+     * @brief The hops of a pair of airports with no route between them.
+     */
+    static const std::uint8_t NoHops;
+
+    /**
+     * @brief The distance of a pair of airports with no measurable route between them.
+     */
+    static const std::uint16_t NoDistance;
+
+    /**
+     * @brief Default constructor for the DistanceMatrix class.
+     * Creates a matrix with no file open.
+     */
+    DistanceMatrix();
+
+    DistanceMatrix(const DistanceMatrix &) = delete;
+    DistanceMatrix &operator=(const DistanceMatrix &) = delete;
+
+    /**
+     * @brief Computes the matrix of a route graph and writes it to a file.
+     *
+     * The file is written to a temporary file first and then renamed over the old one, so a process opening the
+     * matrix at the same time never maps a half-written file.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param filename The name of the file to write.
+     * @param threads The number of threads to search with, or 0 to use every hardware thread.
+     * @return True if the file was written, false otherwise.
+     */
+    static bool compute(const FlightGraph &graph, const std::string &filename, unsigned threads = 0);
+
+    /**
+     * @brief Maps a matrix file, if it was computed from the given route graph.
+     *
+     * @param filename The name of the file to map.
+     * @param graph The route graph the matrix must have been computed from.
+     * @return True if the file was mapped, false if it is missing, damaged, of another format version or stale.
+     */
+    bool open(const std::string &filename, const FlightGraph &graph);
+
+    /**
+     * @brief Checks whether a matrix file is open.
+     *
+     * @return True if a matrix file is open, false otherwise.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Gets the number of airports of the open matrix.
+     *
+     * @return The number of airports, or 0 if no file is open.
+     */
+    std::uint32_t airportCount() const;
+
+    /**
+     * @brief Looks up the fewest flights from one airport to another.
+     *
+     * @param from The id of the start airport.
+     * @param to The id of the goal airport.
+     * @return The number of flights, or NoHops if the goal cannot be reached.
+     */
+    std::uint8_t hops(std::uint32_t from, std::uint32_t to) const;
+
+    /**
+     * @brief Looks up the length of the shortest route from one airport to another.
+     *
+     * @param from The id of the start airport.
+     * @param to The id of the goal airport.
+     * @return The length in whole kilometers, or NoDistance if no measurable route reaches the goal.
+     */
+    std::uint16_t distance(std::uint32_t from, std::uint32_t to) const;
+};
+
+#endif // DISTANCE_MATRIX_H
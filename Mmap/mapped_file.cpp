@@ -0,0 +1,101 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mapped_file.h"
+
+/**
+ * @brief Default constructor for the MappedFile class.
+ * Creates an object with nothing mapped.
+ */
+MappedFile::MappedFile()
+{
+    this->Data = nullptr;
+    this->Size = 0;
+}
+
+/**
+ * @brief Unmaps the file, if one is mapped.
+ */
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+/**
+ * @brief Maps a file, replacing any file that is already mapped.
+ *
+ * @param filename The name of the file to map.
+ * @return True if the file was mapped, false if it could not be opened or mapped.
+ */
+bool MappedFile::open(const std::string &filename)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // an empty file opens successfully but has nothing to map
+    if (status.st_size > 0)
+    {
+        void *mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            ::close(fd);
+            return false;
+        }
+        madvise(mapping, static_cast<std::size_t>(status.st_size), MADV_SEQUENTIAL);
+        Data = static_cast<const char *>(mapping);
+        Size = static_cast<std::size_t>(status.st_size);
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    return true;
+}
+
+/**
+ * @brief Unmaps the file, if one is mapped.
+ */
+void MappedFile::close()
+{
+    if (Data != nullptr)
+    {
+        munmap(const_cast<char *>(Data), Size);
+    }
+    Data = nullptr;
+    Size = 0;
+}
+
+/**
+ * @brief Gets the contents of the mapped file.
+ *
+ * @return A pointer to the first byte of the file, or nullptr if the file is empty or nothing is mapped.
+ */
+const char *MappedFile::data() const
+{
+    return Data;
+}
+
+/**
+ * @brief Gets the size of the mapped file.
+ *
+ * @return The size of the file in bytes.
+ */
+std::size_t MappedFile::size() const
+{
+    return Size;
+}
@@ -0,0 +1,66 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * @class MappedFile
+ * @brief A read-only memory mapping of a whole file.
+ *
+ * The file contents are mapped straight into the address space, so readers can scan them in place without
+ * copying them into stream buffers or strings. The mapping is released when the object is destroyed.
+ */
+class MappedFile
+{
+
+private:
+    const char *Data; /**< The first byte of the mapping, or nullptr if nothing is mapped. */
+    std::size_t Size; /**< The size of the mapped file in bytes. */
+
+public:
+    /**
+     * @brief Default constructor for the MappedFile class.
+     * Creates an object with nothing mapped.
+     */
+    MappedFile();
+
+    /**
+     * @brief Unmaps the file, if one is mapped.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief Maps a file, replacing any file that is already mapped.
+     *
+     * @param filename The name of the file to map.
+     * @return True if the file was mapped, false if it could not be opened or mapped.
+     */
+    bool open(const std::string &filename);
+
+    /**
+     * @brief Unmaps the file, if one is mapped.
+     */
+    void close();
+
+    /**
+     * @brief Gets the contents of the mapped file.
+     *
+     * @return A pointer to the first byte of the file, or nullptr if the file is empty or nothing is mapped.
+     */
+    const char *data() const;
+
+    /**
+     * @brief Gets the size of the mapped file.
+     *
+     * @return The size of the file in bytes.
+     */
+    std::size_t size() const;
+};
+
+#endif // MAPPED_FILE_H
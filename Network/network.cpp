@@ -0,0 +1,575 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include "network.h"
+#include "../Routes/routes.h"
+#include "../Airports/airports.h"
+#include "../Snapshot/snapshot.h"
+
+std::shared_ptr<const Network> Network::Current(new Network());
+std::mutex Network::LoadMutex;
+std::thread Network::ReloadThread;
+std::atomic<bool> Network::Reloading(false);
+std::string Network::SnapshotFilename;
+std::string Network::AirportFilename;
+std::string Network::RouteFilename;
+bool Network::TablesPublished = false;
+
+/**
+ * @brief Swaps the contents of the Airport and Route tables with a set of tables.
+ * Maps swap their nodes, so Airport::AirportsById keeps pointing at the airports it was built from.
+ *
+ * @param tables The tables to swap with.
+ */
+void Network::swapTables(Tables &tables)
+{
+    std::swap(Airport::AirportMap, tables.AirportMap);
+    std::swap(Airport::AirportIds, tables.AirportIds);
+    std::swap(Airport::CityIndex, tables.CityIndex);
+    std::swap(Airport::AirportsById, tables.AirportsById);
+    std::swap(Airport::LocationIndex, tables.LocationIndex);
+    std::swap(Route::AirportRoutesMap, tables.AirportRoutesMap);
+    std::swap(Route::AirlineRoutesMap, tables.AirlineRoutesMap);
+    std::swap(Route::RouteGraph, tables.RouteGraph);
+    std::swap(Route::RouteHierarchy, tables.RouteHierarchy);
+    std::swap(Route::RouteAirlines, tables.RouteAirlines);
+}
+
+/**
+ * @brief Copies the airports held in the Airport tables.
+ * Airport::AirportsById points into AirportMap, which the next load refills, so the records are copied out of it.
+ *
+ * @return The airport records, cities and locations.
+ */
+std::shared_ptr<const Network::AirportData> Network::captureAirports()
+{
+    std::shared_ptr<AirportData> airports(new AirportData());
+    airports->Records.resize(Airport::AirportsById.size());
+    for (std::size_t id = 0; id < Airport::AirportsById.size(); id++)
+    {
+        if (Airport::AirportsById[id] != nullptr)
+        {
+            airports->Records[id] = *Airport::AirportsById[id];
+        }
+    }
+    airports->Cities = Airport::CityIndex;
+    airports->Locations = Airport::LocationIndex;
+    return airports;
+}
+
+/**
+ * @brief Copies the routes held in the Airport and Route tables into a network with the given airports.
+ *
+ * @param airports The airports of the network, which must match the Airport tables.
+ * @return The new network.
+ */
+std::shared_ptr<const Network> Network::capture(std::shared_ptr<const AirportData> airports)
+{
+    std::shared_ptr<Network> network(new Network());
+    network->Ids = Airport::AirportIds;
+    network->Airports = std::move(airports);
+    network->Graph = Route::RouteGraph;
+    network->Hierarchy = Route::RouteHierarchy;
+    network->Airlines = Route::RouteAirlines;
+    return network;
+}
+
+/**
+ * @brief Copies the network held in the Airport and Route tables.
+ *
+ * @return The new network.
+ */
+std::shared_ptr<const Network> Network::capture()
+{
+    return capture(captureAirports());
+}
+
+/**
+ * @brief Pins the current network.
+ * Can be called from any thread, also while a reload publishes a new network.
+ *
+ * @return The current network; an empty network if none has been published.
+ */
+std::shared_ptr<const Network> Network::current()
+{
+    return std::atomic_load(&Current);
+}
+
+/**
+ * @brief Makes a network the current one.
+ * Queries that pinned the previous network keep it until they finish.
+ *
+ * @param network The network to publish.
+ */
+void Network::publish(std::shared_ptr<const Network> network)
+{
+    std::atomic_store(&Current, std::move(network));
+}
+
+/**
+ * @brief Loads the network into the Airport and Route tables and publishes it.
+ *
+ * The tables are only scratch space for building the next network: queries read the published copy, never the
+ * tables, so they can be refilled while queries run. Loads are serialized, since they share the tables. The previous
+ * tables are moved aside rather than cleared, so a failed load leaves the tables holding the current network, which
+ * a route delta can still be applied to.
+ *
+ * @param snapshot_filename The name of the snapshot file.
+ * @param airport_filename The name of the airport file.
+ * @param route_filename The name of the route file.
+ * @return True if the network was loaded and published, false if a data file could not be read; the current
+ * network is then left as it was.
+ */
+bool Network::load(const std::string &snapshot_filename, const std::string &airport_filename, const std::string &route_filename)
+{
+    std::lock_guard<std::mutex> lock(LoadMutex);
+    SnapshotFilename = snapshot_filename;
+    AirportFilename = airport_filename;
+    RouteFilename = route_filename;
+    Tables previous;
+    swapTables(previous);
+
+    // a snapshot written from the current data files skips CSV parsing entirely
+    if (!Snapshot::load(snapshot_filename, airport_filename, route_filename))
+    {
+        // a snapshot that failed part way may have filled some tables
+        Tables partial;
+        swapTables(partial);
+
+        // one pass over the route file builds the airport routes, the airline routes and the route graph
+        Airport::AirportFileReader(airport_filename);
+        if (Airport::AirportMap.empty() || !Route::RouteFileReader(route_filename))
+        {
+            swapTables(previous);
+            return false;
+        }
+        Route::buildRouteHierarchy();
+        Snapshot::write(snapshot_filename, airport_filename, route_filename);
+    }
+
+    publish(capture());
+    TablesPublished = true;
+    std::cout << "> Network published..." << std::endl;
+    return true;
+}
+
+/**
+ * @brief Runs a task on the background thread, unless a task is already running there.
+ *
+ * @param message The progress message printed when the task starts.
+ * @param task The task.
+ * @return True if the task was started, false if a task is already running.
+ */
+bool Network::runInBackground(const std::string &message, std::function<void()> task)
+{
+    bool idle = false;
+    if (!Reloading.compare_exchange_strong(idle, true))
+    {
+        std::cout << "> Reload already running..." << std::endl;
+        return false;
+    }
+
+    // the last task has finished, so this only reclaims its thread
+    if (ReloadThread.joinable())
+    {
+        ReloadThread.join();
+    }
+    std::cout << message << std::endl;
+    ReloadThread = std::thread([task]()
+    {
+        task();
+        Reloading = false;
+    });
+    return true;
+}
+
+/**
+ * @brief Starts reloading the network from the files of the last load on a background thread.
+ * Queries go on against the current network while the next one is built.
+ *
+ * @return True if the reload was started, false if a reload or update is already running or nothing was loaded yet.
+ */
+bool Network::reloadInBackground()
+{
+    std::string snapshot_filename;
+    std::string airport_filename;
+    std::string route_filename;
+    {
+        std::lock_guard<std::mutex> lock(LoadMutex);
+        snapshot_filename = SnapshotFilename;
+        airport_filename = AirportFilename;
+        route_filename = RouteFilename;
+    }
+    if (airport_filename.empty())
+    {
+        return false;
+    }
+
+    return runInBackground("> Reloading network...", [snapshot_filename, airport_filename, route_filename]()
+    {
+        if (!load(snapshot_filename, airport_filename, route_filename))
+        {
+            std::cout << "error reloading network: the current network is kept" << std::endl;
+        }
+    });
+}
+
+/**
+ * @brief Applies a route delta file to the loaded network and publishes the result.
+ *
+ * Applying the delta and copying the route graph, airlines and ids into the published network take a few passes over
+ * the packed arrays however small the delta, which is milliseconds, so the changed routes are published at once,
+ * without a contraction hierarchy; Network::findShortestRoute falls back to A* until the rebuilt hierarchy is published a few seconds later.
+ * The hierarchy is built from the published graph without holding the tables, so loads are not held up by it; if
+ * one publishes a newer network meanwhile, the hierarchy is dropped. The delta only changes the tables in memory:
+ * the next load starts again from the data files.
+ *
+ * @param delta_filename The name of the route delta file.
+ * @return True if the delta was applied and published, false if the file could not be read or no network is loaded.
+ */
+bool Network::applyDelta(const std::string &delta_filename)
+{
+    std::shared_ptr<const Network> published;
+    {
+        std::lock_guard<std::mutex> lock(LoadMutex);
+        if (!TablesPublished)
+        {
+            std::cout << "error applying route delta: no network is loaded" << std::endl;
+            return false;
+        }
+        RouteDelta delta;
+        if (!Route::RouteDeltaReader(delta_filename, delta))
+        {
+            return false;
+        }
+        // a delta only changes routes, so the airports of the current network are shared rather than copied
+        Route::applyRouteDelta(delta);
+        published = capture(current()->Airports);
+        publish(published);
+        std::cout << "> Network published..." << std::endl;
+    }
+
+    ContractionHierarchy hierarchy = ContractionHierarchy::build(published->graph());
+    std::cout << "> Route hierarchy created..." << std::endl;
+
+    std::lock_guard<std::mutex> lock(LoadMutex);
+    if (current() != published)
+    {
+        std::cout << "> Route hierarchy dropped: the network changed while it was built..." << std::endl;
+        return true;
+    }
+    Route::RouteHierarchy = std::move(hierarchy);
+    publish(capture(published->Airports));
+    std::cout << "> Network published..." << std::endl;
+    return true;
+}
+
+/**
+ * @brief Starts applying a route delta file on a background thread.
+ * Queries go on against the current network while the delta is applied.
+ *
+ * @param delta_filename The name of the route delta file.
+ * @return True if the update was started, false if a reload or update is already running.
+ */
+bool Network::applyDeltaInBackground(const std::string &delta_filename)
+{
+    return runInBackground("> Applying route delta...", [delta_filename]()
+    {
+        if (!applyDelta(delta_filename))
+        {
+            std::cout << "error applying route delta: the current network is kept" << std::endl;
+        }
+    });
+}
+
+/**
+ * @brief Lists every route of a network with its length and airlines, by IATA code rather than id, so networks that
+ * number their airports differently can be compared.
+ *
+ * @param network The network.
+ * @return A line per route, such as "ACC -> LHR 5087.1 km BA/0", in sorted order; lengths are printed exactly.
+ */
+static std::vector<std::string> routeLines(const Network &network)
+{
+    std::vector<std::string> lines;
+    const FlightGraph &graph = network.graph();
+    const AirlineIndex &airlines = network.airlines();
+    char length[32];
+    for (std::uint32_t source = 0; source < graph.airportCount(); source++)
+    {
+        for (const std::uint32_t *destination = graph.successorsBegin(source); destination != graph.successorsEnd(source); destination++)
+        {
+            std::uint32_t edge = static_cast<std::uint32_t>(destination - graph.neighbors().data());
+            std::snprintf(length, sizeof(length), "%.17g", graph.routeDistance(edge));
+            std::string line = network.ids().code(source).toString() + " -> " + network.ids().code(*destination).toString() + " " + length + " km";
+            if (edge < airlines.routeCount())
+            {
+                for (const EdgeAirline *airline = airlines.airlinesBegin(edge); airline != airlines.airlinesEnd(edge); airline++)
+                {
+                    line += " " + airline->Airline.toString() + "/" + std::to_string(airline->Stops);
+                }
+            }
+            lines.push_back(std::move(line));
+        }
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+/**
+ * @brief Checks that applying a route delta file gives the same network as loading the route file it was made for,
+ * and reports the routes that differ.
+ *
+ * Routes are compared by IATA code, with their exact lengths and their airlines, since an airport only named by the
+ * route file keeps its id after a delta removes its every row, while a load leaves it out. The edited route file is
+ * loaded from the data files, never from the snapshot, and without a contraction hierarchy; the snapshot is left
+ * alone.
+ *
+ * @param delta_filename The name of the route delta file.
+ * @param edited_route_filename The name of the route file with the delta's removed rows taken out and its added rows
+ * appended.
+ * @return True if both networks have the same routes, with the same lengths and airlines; false if they differ or a
+ * file could not be read.
+ */
+bool Network::checkDelta(const std::string &delta_filename, const std::string &edited_route_filename)
+{
+    if (!applyDelta(delta_filename))
+    {
+        return false;
+    }
+    std::shared_ptr<const Network> applied = current();
+
+    std::shared_ptr<const Network> loaded;
+    {
+        std::lock_guard<std::mutex> lock(LoadMutex);
+        Tables tables;
+        swapTables(tables);
+        Airport::AirportFileReader(AirportFilename);
+        if (!Airport::AirportMap.empty() && Route::RouteFileReader(edited_route_filename))
+        {
+            loaded = capture();
+        }
+        swapTables(tables);
+    }
+    if (loaded == nullptr)
+    {
+        std::cout << "error checking route delta: the edited route file could not be loaded" << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> appliedLines = routeLines(*applied);
+    std::vector<std::string> loadedLines = routeLines(*loaded);
+    std::vector<std::string> appliedOnly;
+    std::vector<std::string> loadedOnly;
+    std::set_difference(appliedLines.begin(), appliedLines.end(), loadedLines.begin(), loadedLines.end(), std::back_inserter(appliedOnly));
+    std::set_difference(loadedLines.begin(), loadedLines.end(), appliedLines.begin(), appliedLines.end(), std::back_inserter(loadedOnly));
+    if (appliedOnly.empty() && loadedOnly.empty())
+    {
+        std::cout << "> Route delta checked: all " << appliedLines.size() << " routes match a load of " << edited_route_filename << "..." << std::endl;
+        return true;
+    }
+
+    std::cout << "error checking route delta: the routes differ from a load of " << edited_route_filename << ", "
+              << appliedOnly.size() << " only after the delta and " << loadedOnly.size() << " only after the load" << std::endl;
+    for (std::size_t i = 0; i < appliedOnly.size() && i < 10; i++)
+    {
+        std::cout << "  >> only after the delta: " << appliedOnly[i] << std::endl;
+    }
+    for (std::size_t i = 0; i < loadedOnly.size() && i < 10; i++)
+    {
+        std::cout << "  >> only after the load: " << loadedOnly[i] << std::endl;
+    }
+    return false;
+}
+
+/**
+ * @brief Checks whether a background reload or update is running.
+ *
+ * @return True while a reload or update runs, when a new one would be refused.
+ */
+bool Network::reloadRunning()
+{
+    return Reloading;
+}
+
+/**
+ * @brief Waits until the background reload or update, if any, has finished.
+ * Must be called from the thread that starts them.
+ */
+void Network::waitForReload()
+{
+    if (ReloadThread.joinable())
+    {
+        ReloadThread.join();
+    }
+}
+
+/**
+ * @brief Gets the ids of the airports.
+ *
+ * @return The table of airport ids.
+ */
+const IataTable &Network::ids() const
+{
+    return Ids;
+}
+
+/**
+ * @brief Gets the route graph.
+ *
+ * @return The route graph, with its routes measured.
+ */
+const FlightGraph &Network::graph() const
+{
+    return Graph;
+}
+
+/**
+ * @brief Gets the airlines flying every route of the graph.
+ *
+ * @return The airline index.
+ */
+const AirlineIndex &Network::airlines() const
+{
+    return Airlines;
+}
+
+/**
+ * @brief Looks up the airport record of an airport id in constant time.
+ *
+ * @param id The id of the airport.
+ * @return The airport, or nullptr if the id has no record in the airport file.
+ */
+const Airport *Network::findAirport(std::uint32_t id) const
+{
+    if (id >= Airports->Records.size() || !Airports->Records[id].getIataCode().isValid())
+    {
+        return nullptr;
+    }
+    return &Airports->Records[id];
+}
+
+/**
+ * @brief Finds the airline with the fewest stops on the route between two airports.
+ *
+ * @param source The id of the airport the route leaves.
+ * @param destination The id of the airport the route arrives at.
+ * @return The airline and its stops, or nullptr if no airline is known to fly the route.
+ */
+const EdgeAirline *Network::findAirline(std::uint32_t source, std::uint32_t destination) const
+{
+    std::uint32_t edge = Graph.findEdge(source, destination);
+    if (edge == IataTable::NoId || edge >= Airlines.routeCount() || Airlines.airlinesBegin(edge) == Airlines.airlinesEnd(edge))
+    {
+        return nullptr;
+    }
+    return Airlines.airlinesBegin(edge);
+}
+
+/**
+ * @brief Looks up the airports of a city with one lookup in the city index.
+ *
+ * @param city The name of the city.
+ * @param country The name of the country the city is in.
+ * @return The ids of the airports in the city, in IATA code order; empty if the city is not known.
+ */
+const std::vector<std::uint32_t> &Network::findCity(const std::string &city, const std::string &country) const
+{
+    static const std::vector<std::uint32_t> none;
+    auto it = Airports->Cities.find(Airport::cityKey(city, country));
+    if (it == Airports->Cities.end())
+    {
+        return none;
+    }
+    return it->second;
+}
+
+/**
+ * @brief Finds the airports closest to a position.
+ *
+ * @param lat The latitude of the position in degrees.
+ * @param lon The longitude of the position in degrees.
+ * @param k The number of airports to find.
+ * @return The ids of the k closest airports and their distances from the position, closest first.
+ */
+std::vector<NearbyAirport> Network::nearest(double lat, double lon, std::size_t k) const
+{
+    return Airports->Locations.nearest(lat, lon, k);
+}
+
+/**
+ * @brief Finds the airports within a distance of a position.
+ *
+ * @param lat The latitude of the position in degrees.
+ * @param lon The longitude of the position in degrees.
+ * @param radius The largest distance in kilometers.
+ * @return The ids of the airports within the distance and their distances from the position, closest first.
+ */
+std::vector<NearbyAirport> Network::within(double lat, double lon, double radius) const
+{
+    return Airports->Locations.within(lat, lon, radius);
+}
+
+/**
+ * @brief Finds the route with the fewest flights from any of several start airports to any of several goal
+ * airports, searching forwards from the starts and backwards from the goals at once, so hub airports do not flood
+ * the search.
+ *
+ * @param starts The ids of the airports the route may start at.
+ * @param goals The ids of the airports the route may end at.
+ * @return The route with the fewest flights, or an empty result if no goal can be reached.
+ */
+SearchResult Network::fewestHops(const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals) const
+{
+    return RouteSearch::fewestHops(Graph, starts, goals);
+}
+
+/**
+ * @brief Finds the route with the smallest total great-circle distance from any of several start airports to any
+ * of several goal airports.
+ *
+ * @param starts The ids of the airports the route may start at.
+ * @param goals The ids of the airports the route may end at.
+ * @param mode The algorithm to search with; Hierarchy falls back to A* if the network has no hierarchy.
+ * @return The shortest route, or an empty result if no goal can be reached.
+ */
+SearchResult Network::findShortestRoute(const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals, SearchMode mode) const
+{
+    if (mode == SearchMode::Hierarchy && Hierarchy.airportCount() == Graph.airportCount())
+    {
+        return Hierarchy.shortestRoute(starts, goals);
+    }
+    if (mode == SearchMode::Dijkstra)
+    {
+        return RouteSearch::dijkstra(Graph, starts, goals);
+    }
+    if (mode == SearchMode::Bidirectional)
+    {
+        return RouteSearch::bidirectional(Graph, starts, goals);
+    }
+    return RouteSearch::aStar(Graph, starts, goals);
+}
+
+/**
+ * @brief Finds the k shortest loopless routes from any of several start airports to any of several goal airports.
+ *
+ * @param starts The ids of the airports the routes may start at.
+ * @param goals The ids of the airports the routes may end at.
+ * @param k The number of routes to find.
+ * @return Up to k distinct routes, shortest first.
+ */
+std::vector<SearchResult> Network::findShortestRoutes(const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals, std::size_t k) const
+{
+    return RouteSearch::kShortest(Graph, starts, goals, k);
+}
@@ -0,0 +1,317 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include "../Iata/iata.h"
+#include "../Routes/routes.h"
+#include "../Airports/airports.h"
+#include "../Graph/flight_graph.h"
+#include "../Graph/airline_index.h"
+#include "../Search/route_search.h"
+#include "../Hierarchy/contraction_hierarchy.h"
+
+/**
+ * @class Network
+ * @brief An immutable copy of everything queries read from the loaded network: airport ids and records, cities,
+ * airport locations, the route graph, its contraction hierarchy and its airlines.
+ *
+ * The current network is held by a shared pointer. A query pins it by taking a copy of the pointer with current()
+ * and plans against that copy only, so it sees one consistent network however long it runs. A reload builds the
+ * next network from the data files in the Airport and Route tables, then swaps it in atomically; queries already
+ * running keep the network they pinned, which is freed when the last of them lets go of it. A route delta is
+ * published the same way, after it has been applied to the tables.
+ */
+class Network
+{
+
+private:
+    /**
+     * @struct Tables
+     * @brief The contents of the Airport and Route tables, set aside while a load refills them.
+     */
+    struct Tables
+    {
+        std::map<IataCode, Airport> AirportMap; /**< Airport::AirportMap. */
+        IataTable AirportIds; /**< Airport::AirportIds. */
+        std::unordered_map<std::string, std::vector<std::uint32_t>> CityIndex; /**< Airport::CityIndex. */
+        std::vector<const Airport *> AirportsById; /**< Airport::AirportsById, pointing into AirportMap. */
+        AirportTree LocationIndex; /**< Airport::LocationIndex. */
+        std::map<IataCode, std::vector<IataCode>> AirportRoutesMap; /**< Route::AirportRoutesMap. */
+        std::map<AirlineRouteKey, std::vector<IataCode>> AirlineRoutesMap; /**< Route::AirlineRoutesMap. */
+        FlightGraph RouteGraph; /**< Route::RouteGraph. */
+        ContractionHierarchy RouteHierarchy; /**< Route::RouteHierarchy. */
+        AirlineIndex RouteAirlines; /**< Route::RouteAirlines. */
+    };
+
+    /**
+     * @struct AirportData
+     * @brief The airports of a network, which only a load changes; the networks published for a route delta share
+     * them with the network the delta was applied to.
+     */
+    struct AirportData
+    {
+        std::vector<Airport> Records; /**< The record of every airport id; a default record, with an invalid IATA code, for airports missing from the airport file. */
+        std::unordered_map<std::string, std::vector<std::uint32_t>> Cities; /**< The ids of the airports of every city, by Airport::cityKey. */
+        AirportTree Locations; /**< A spatial index over the airports with coordinates. */
+    };
+
+    IataTable Ids; /**< The ids of the airports, in the numbering of Graph. */
+    std::shared_ptr<const AirportData> Airports = std::make_shared<AirportData>(); /**< The airport records, cities and locations. */
+    FlightGraph Graph; /**< The route graph, with its routes measured. */
+    ContractionHierarchy Hierarchy; /**< The contraction hierarchy of Graph, or an empty one if none was built. */
+    AirlineIndex Airlines; /**< The airlines flying every route of Graph. */
+
+    static std::shared_ptr<const Network> Current; /**< The network new queries pin. */
+    static std::mutex LoadMutex; /**< Serializes loads, which build in the Airport and Route tables. */
+    static std::thread ReloadThread; /**< The thread of the last background reload or update. */
+    static std::atomic<bool> Reloading; /**< Set while a background reload or update runs. */
+    static std::string SnapshotFilename; /**< The snapshot file of the last load. */
+    static std::string AirportFilename; /**< The airport file of the last load. */
+    static std::string RouteFilename; /**< The route file of the last load. */
+    static bool TablesPublished; /**< Set while the Airport and Route tables hold the current network. */
+
+    /**
+     * @brief Creates an empty network, with no airports and no routes.
+     */
+    Network() = default;
+
+    /**
+     * @brief Swaps the contents of the Airport and Route tables with a set of tables.
+     *
+     * @param tables The tables to swap with.
+     */
+    static void swapTables(Tables &tables);
+
+    /**
+     * @brief Runs a task on the background thread, unless a task is already running there.
+     *
+     * @param message The progress message printed when the task starts.
+     * @param task The task.
+     * @return True if the task was started, false if a task is already running.
+     */
+    static bool runInBackground(const std::string &message, std::function<void()> task);
+
+    /**
+     * @brief Copies the airports held in the Airport tables.
+     *
+     * @return The airport records, cities and locations.
+     */
+    static std::shared_ptr<const AirportData> captureAirports();
+
+    /**
+     * @brief Copies the routes held in the Airport and Route tables into a network with the given airports.
+     *
+     * @param airports The airports of the network, which must match the Airport tables.
+     * @return The new network.
+     */
+    static std::shared_ptr<const Network> capture(std::shared_ptr<const AirportData> airports);
+
+public:
+    /**
+     * @brief Copies the network held in the Airport and Route tables.
+     *
+     * @return The new network.
+     */
+    static std::shared_ptr<const Network> capture();
+
+    /**
+     * @brief Pins the current network.
+     * Can be called from any thread, also while a reload publishes a new network.
+     *
+     * @return The current network; an empty network if none has been published.
+     */
+    static std::shared_ptr<const Network> current();
+
+    /**
+     * @brief Makes a network the current one.
+     * Queries that pinned the previous network keep it until they finish.
+     *
+     * @param network The network to publish.
+     */
+    static void publish(std::shared_ptr<const Network> network);
+
+    /**
+     * @brief Loads the network into the Airport and Route tables and publishes it.
+     * Loads from the snapshot if it was written from the given data files, otherwise from the data files, after which
+     * the contraction hierarchy is built and the snapshot rewritten. The tables are emptied first, so a load also
+     * serves as a reload; if it fails, they are put back as they were.
+     *
+     * @param snapshot_filename The name of the snapshot file.
+     * @param airport_filename The name of the airport file.
+     * @param route_filename The name of the route file.
+     * @return True if the network was loaded and published, false if a data file could not be read; the current
+     * network is then left as it was.
+     */
+    static bool load(const std::string &snapshot_filename, const std::string &airport_filename, const std::string &route_filename);
+
+    /**
+     * @brief Starts reloading the network from the files of the last load on a background thread.
+     * Queries go on against the current network while the next one is built.
+     *
+     * @return True if the reload was started, false if a reload or update is already running or nothing was loaded yet.
+     */
+    static bool reloadInBackground();
+
+    /**
+     * @brief Applies a route delta file to the loaded network and publishes the result.
+     * The changed network is published as soon as the delta is applied, with searches falling back from the
+     * contraction hierarchy to A*. Applying the delta rebuilds the packed route graph and airline index, and
+     * publishing copies them with the airport ids, so both grow with the network rather than the delta, taking
+     * milliseconds; the airports are shared with the current network rather than copied. The hierarchy is then rebuilt from scratch, which
+     * takes seconds, without holding the tables, and the network published again. A background reload or update
+     * requested during the rebuild is refused. The snapshot is left alone, since it stands for the data files.
+     *
+     * @param delta_filename The name of the route delta file.
+     * @return True if the delta was applied and published, false if the file could not be read or no network is
+     * loaded.
+     */
+    static bool applyDelta(const std::string &delta_filename);
+
+    /**
+     * @brief Starts applying a route delta file on a background thread.
+     * Queries go on against the current network while the delta is applied.
+     *
+     * @param delta_filename The name of the route delta file.
+     * @return True if the update was started, false if a reload or update is already running.
+     */
+    static bool applyDeltaInBackground(const std::string &delta_filename);
+
+    /**
+     * @brief Checks that applying a route delta file gives the same network as loading the route file it was made
+     * for, and reports the routes that differ.
+     * The delta is applied to the loaded network and published like applyDelta does; the edited route file is then
+     * loaded with the airport file of the last load, aside from the tables, which are put back afterwards.
+     *
+     * @param delta_filename The name of the route delta file.
+     * @param edited_route_filename The name of the route file with the delta's removed rows taken out and its added
+     * rows appended.
+     * @return True if both networks have the same routes, with the same lengths and airlines; false if they differ or
+     * a file could not be read.
+     */
+    static bool checkDelta(const std::string &delta_filename, const std::string &edited_route_filename);
+
+    /**
+     * @brief Checks whether a background reload or update is running.
+     *
+     * @return True while a reload or update runs, when a new one would be refused.
+     */
+    static bool reloadRunning();
+
+    /**
+     * @brief Waits until the background reload or update, if any, has finished.
+     */
+    static void waitForReload();
+
+    /**
+     * @brief Gets the ids of the airports.
+     *
+     * @return The table of airport ids.
+     */
+    const IataTable &ids() const;
+
+    /**
+     * @brief Gets the route graph.
+     *
+     * @return The route graph, with its routes measured.
+     */
+    const FlightGraph &graph() const;
+
+    /**
+     * @brief Gets the airlines flying every route of the graph.
+     *
+     * @return The airline index.
+     */
+    const AirlineIndex &airlines() const;
+
+    /**
+     * @brief Looks up the airport record of an airport id in constant time.
+     *
+     * @param id The id of the airport.
+     * @return The airport, or nullptr if the id has no record in the airport file.
+     */
+    const Airport *findAirport(std::uint32_t id) const;
+
+    /**
+     * @brief Finds the airline with the fewest stops on the route between two airports.
+     *
+     * @param source The id of the airport the route leaves.
+     * @param destination The id of the airport the route arrives at.
+     * @return The airline and its stops, or nullptr if no airline is known to fly the route.
+     */
+    const EdgeAirline *findAirline(std::uint32_t source, std::uint32_t destination) const;
+
+    /**
+     * @brief Looks up the airports of a city.
+     * Case and spacing of the names do not matter.
+     *
+     * @param city The name of the city.
+     * @param country The name of the country the city is in.
+     * @return The ids of the airports in the city, in IATA code order; empty if the city is not known.
+     */
+    const std::vector<std::uint32_t> &findCity(const std::string &city, const std::string &country) const;
+
+    /**
+     * @brief Finds the airports closest to a position.
+     *
+     * @param lat The latitude of the position in degrees.
+     * @param lon The longitude of the position in degrees.
+     * @param k The number of airports to find.
+     * @return The ids of the k closest airports and their distances from the position, closest first.
+     */
+    std::vector<NearbyAirport> nearest(double lat, double lon, std::size_t k) const;
+
+    /**
+     * @brief Finds the airports within a distance of a position.
+     *
+     * @param lat The latitude of the position in degrees.
+     * @param lon The longitude of the position in degrees.
+     * @param radius The largest distance in kilometers.
+     * @return The ids of the airports within the distance and their distances from the position, closest first.
+     */
+    std::vector<NearbyAirport> within(double lat, double lon, double radius) const;
+
+    /**
+     * @brief Finds the route with the fewest flights from any of several start airports to any of several goal
+     * airports, searching from both ends at once.
+     *
+     * @param starts The ids of the airports the route may start at.
+     * @param goals The ids of the airports the route may end at.
+     * @return The route with the fewest flights, or an empty result if no goal can be reached.
+     */
+    SearchResult fewestHops(const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals) const;
+
+    /**
+     * @brief Finds the route with the smallest total great-circle distance from any of several start airports to
+     * any of several goal airports.
+     *
+     * @param starts The ids of the airports the route may start at.
+     * @param goals The ids of the airports the route may end at.
+     * @param mode The algorithm to search with; Hierarchy falls back to A* if the network has no hierarchy.
+     * @return The shortest route, or an empty result if no goal can be reached.
+     */
+    SearchResult findShortestRoute(const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals, SearchMode mode) const;
+
+    /**
+     * @brief Finds the k shortest loopless routes from any of several start airports to any of several goal airports.
+     *
+     * @param starts The ids of the airports the routes may start at.
+     * @param goals The ids of the airports the routes may end at.
+     * @param k The number of routes to find.
+     * @return Up to k distinct routes, shortest first.
+     */
+    std::vector<SearchResult> findShortestRoutes(const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals, std::size_t k) const;
+};
+
+#endif // NETWORK_H
@@ -0,0 +1,54 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <vector>
+#include <cstdint>
+#include "flight_plan.h"
+
+/**
+ * @brief Turns a route found by a search into a flight plan.
+ *
+ * Each leg's route is looked up once in the graph; its index gives both the length measured at load time and the
+ * airlines flying it, of which the most direct one is taken. The plan keeps the length the search found for the whole
+ * route, so it matches the search exactly.
+ *
+ * @param route The route found by the search.
+ * @param graph The route graph the route was found in, with its routes measured.
+ * @param airlines The airline index of the graph.
+ * @return The flight plan, or a plan that is not Found if the search found no route.
+ */
+FlightPlan FlightPlan::fromRoute(const SearchResult &route, const FlightGraph &graph, const AirlineIndex &airlines)
+{
+    FlightPlan plan;
+    plan.Expanded = route.Expanded;
+    if (!route.found())
+    {
+        return plan;
+    }
+    plan.Found = true;
+    plan.Distance = route.Distance;
+
+    plan.Legs.reserve(route.Path.size() - 1);
+    for (std::size_t i = 0; i + 1 < route.Path.size(); i++)
+    {
+        FlightLeg leg;
+        leg.Source = route.Path[i];
+        leg.Destination = route.Path[i + 1];
+        leg.Airline = IataCode();
+        leg.Stops = 0;
+        leg.Distance = 0;
+
+        std::uint32_t edge = graph.findEdge(leg.Source, leg.Destination);
+        if (edge != IataTable::NoId)
+        {
+            leg.Distance = graph.routeDistance(edge);
+            if (edge < airlines.routeCount() && airlines.airlinesBegin(edge) != airlines.airlinesEnd(edge))
+            {
+                leg.Airline = airlines.airlinesBegin(edge)->Airline;
+                leg.Stops = airlines.airlinesBegin(edge)->Stops;
+            }
+        }
+        plan.Stops += leg.Stops;
+        plan.Legs.push_back(leg);
+    }
+    return plan;
+}
@@ -0,0 +1,51 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef FLIGHT_PLAN_H
+#define FLIGHT_PLAN_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../Iata/iata.h"
+#include "../Graph/flight_graph.h"
+#include "../Graph/airline_index.h"
+#include "../Search/route_search.h"
+
+/**
+ * @struct FlightLeg
+ * @brief One flight of a flight plan.
+ */
+struct FlightLeg
+{
+    std::uint32_t Source; /**< The id of the airport the flight leaves. */
+    std::uint32_t Destination; /**< The id of the airport the flight arrives at. */
+    IataCode Airline; /**< The code of the most direct airline flying the route, or an invalid code if none is known. */
+    std::int32_t Stops; /**< The number of stops the airline makes on the route. */
+    double Distance; /**< The great-circle length of the route in kilometers. */
+};
+
+/**
+ * @struct FlightPlan
+ * @brief A planned route as a list of flights, ready to be written out or used by another program.
+ */
+struct FlightPlan
+{
+    std::vector<FlightLeg> Legs; /**< The flights of the plan, in the order they are taken. */
+    double Distance = 0; /**< The great-circle length of the whole route in kilometers. */
+    std::int32_t Stops = 0; /**< The number of additional stops on all flights together. */
+    std::size_t Expanded = 0; /**< The number of airports the search expanded. */
+    bool Found = false; /**< Whether a route was found; a route that starts at a goal airport has no legs. */
+
+    /**
+     * @brief Turns a route found by a search into a flight plan.
+     * Every leg gets its length from the graph and the first airline of the route from the airline index.
+     *
+     * @param route The route found by the search.
+     * @param graph The route graph the route was found in, with its routes measured.
+     * @param airlines The airline index of the graph.
+     * @return The flight plan, or a plan that is not Found if the search found no route.
+     */
+    static FlightPlan fromRoute(const SearchResult &route, const FlightGraph &graph, const AirlineIndex &airlines);
+};
+
+#endif // FLIGHT_PLAN_H
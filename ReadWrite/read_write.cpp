@@ -1,6 +1,9 @@
 //  Created by Omar Basheer on 11/27/22.
 
 #include <vector>
+#include <memory>
+#include <string>
+#include <utility>
 #include <sstream>
 #include <fstream>
 #include <cstring>
@@ -9,12 +12,16 @@
 #include "read_write.h"
 #include "../Routes/routes.h"
 #include "../Airports/airports.h"
-#include "../Haversine/haversine.h"
+#include "../Search/route_search.h"
+#include "../Plan/flight_plan.h"
+#include "../Network/network.h"
+#include "../ThreadPool/thread_pool.h"
 
 std::string ReadWrite::StartCity;/* The start city of a given flight*/
 std::string ReadWrite::StartCountry;/* The start country of a given flight*/
 std::string ReadWrite::Destination_City;/* The destination city of a given flight*/
 std::string ReadWrite::Destination_Country;/* The destination country of a given flight*/
+SearchMode ReadWrite::Search_Mode = SearchMode::Hierarchy;/* The algorithm used to search for routes*/
 
 /**
  * @brief Retrieves the start city for the navigation.
@@ -96,6 +103,26 @@ void ReadWrite::setDestinationCountry(const std::string country)
     Destination_Country = country;
 }
 
+/**
+ * @brief Retrieves the algorithm used to search for routes.
+ *
+ * @return The search mode.
+ */
+SearchMode ReadWrite::getSearchMode()
+{
+    return Search_Mode;
+}
+
+/**
+ * @brief Sets the algorithm used to search for routes.
+ *
+ * @param mode The search mode to use.
+ */
+void ReadWrite::setSearchMode(const SearchMode mode)
+{
+    Search_Mode = mode;
+}
+
 /**
  * @brief Read user input file containing start city and country, and destination city and country
  * @param input_filename  the file name of the users input file
@@ -144,95 +171,78 @@ void ReadWrite::inputFileReader(const std::string &input_filename)
         std::cout << "error opening/reading your file: check that input file is in right directory and the given file name matches" << std::endl;
     }
 
-    std::string start_iata;
-    std::string goal_iata;
-    std::vector<std::string> all_starts;
-    std::vector<std::string> all_goals;
-    Airport tempair1;
-    Airport tempair2;
+    // the whole query is planned against one network, however long it takes
+    std::shared_ptr<const Network> network = Network::current();
+    FlightQuery query;
+    query.StartCity = getStartCity();
+    query.StartCountry = getStartCountry();
+    query.DestinationCity = getDestination_City();
+    query.DestinationCountry = getDestination_Country();
+    std::cout << std::endl;
+    std::cout << "> Starting search..." << std::endl;
+
+    haversineHelper(*network, query);
+}
 
-    // get airport iata code from AirportMap associated with given city and country pair from user's input file
-    for (auto const &pair : Airport::AirportMap)
+/**
+ * @brief Turns the legs of a flight plan back into the airports of its route.
+ * @param plan the flight plan
+ * @return the ids of the airports on the route, start first; empty if the plan has no legs
+ */
+static std::vector<std::uint32_t> planPath(const FlightPlan &plan)
+{
+    std::vector<std::uint32_t> path;
+    for (auto const &leg : plan.Legs)
     {
-        if (pair.first[1] == getStartCity() && pair.first[2] == getStartCountry())
+        if (path.empty())
         {
-            start_iata = pair.first[0];
-            all_starts.emplace_back(start_iata);
-        }
-        if (pair.first[1] == Destination_City && pair.first[2] == Destination_Country)
-        {
-            goal_iata = pair.first[0];
-            all_goals.emplace_back(goal_iata);
+            path.emplace_back(leg.Source);
         }
+        path.emplace_back(leg.Destination);
     }
-    std::cout << std::endl;
-    std::cout << "> Starting search..." << std::endl;
-
-    haversineHelper(all_starts, all_goals);
+    return path;
 }
 
 /**
- *@brief Calculates haversine distance between airports in a solution path and accumulates the values to obtain the total distance between the start and goal airports given a particular solution path. Passes solution path with lowest distance to outputFileWriter for file writing
- *@param all_starts a string vector of the iata codes of all airports in the given start city
- *@param all_goals a string vector of the iata codes of all airports in the given goal city
+ *@brief Finds the route with the smallest total haversine distance from any airport in the start city to any airport in the goal city, in a single search seeded from every start airport that stops at the first goal airport it settles. Route lengths are precomputed at load time. Passes the flight plan to outputFileWriter for file writing
+ *@param network the network to plan in, pinned with Network::current
+ *@param query the start and destination cities
  */
-void ReadWrite::haversineHelper(const std::vector<std::string> all_starts, const std::vector<std::string> all_goals)
+void ReadWrite::haversineHelper(const Network &network, const FlightQuery &query)
 {
-
-    Airport tempair1;
-    Airport tempair2;
-    std::string flight_path;
-    std::vector<std::string> flight_vec;
-    std::map<double, std::string> all_paths;
-
-    // find route for every airport within the start city]
-    for (int i = 0; i < all_starts.size(); i++)
+    // get airport iata codes associated with given city and country pairs from user's input file
+    std::vector<IataCode> all_starts = cityAirports(network, query.StartCity, query.StartCountry);
+    std::vector<IataCode> all_goals = cityAirports(network, query.DestinationCity, query.DestinationCountry);
+    if (all_starts.empty() || all_goals.empty())
     {
-        std::cout << "  >> start number: " << all_starts.size() << std::endl;
-        std::cout << "  >> goal number: " << all_goals.size() << std::endl;
-        std::cout << "  * path " << i + 1 << " *" << std::endl;
-        flight_path = Route::findRoute(all_starts[i], all_goals[all_goals.size() - 1]);
-        flight_vec = Route::stringToVec(flight_path);
+        std::cout << "> No airports found for the given start or destination city" << std::endl;
+        return;
+    }
 
-        // haversine
-        double haversine_distance = 0;
+    std::cout << "  >> start airports: " << Route::vecToString(all_starts) << " ]" << std::endl;
+    std::cout << "  >> goal airports: " << Route::vecToString(all_goals) << " ]" << std::endl;
+    std::cout << "     >>> searching..." << std::endl;
 
-        for (int i = 1; i < flight_vec.size() - 1; i++)
-        {
-            for (auto const &pair : Airport::AirportMap)
-            {
-                if (pair.first[0] == flight_vec[i])
-                {
-                    std::vector<std::string> temp1{pair.first[0], pair.first[1], pair.first[2]};
-                    tempair1 = Airport::AirportMap[temp1];
-                }
-                if (pair.first[0] == flight_vec[i + 1])
-                {
-                    std::vector<std::string> temp2{pair.first[0], pair.first[1], pair.first[2]};
-                    tempair2 = Airport::AirportMap[temp2];
-                }
-            }
-            double latitude1 = stod(tempair1.getLatitude());
-            double latitude2 = stod(tempair2.getLatitude());
-            double longitude1 = stod(tempair1.getLongitude());
-            double longitude2 = stod(tempair2.getLongitude());
-
-            double distance = haversine(latitude1, longitude1, latitude2, longitude2);
-            haversine_distance = haversine_distance + distance;
-        }
-        all_paths.insert(std::pair<double, std::string>(haversine_distance, flight_path));
-        std::cout << "      >>>> haversine distance: " << haversine_distance << " km" << std::endl;
-        std::cout << std::endl;
+    FlightPlan plan = planFlight(network, query);
+    std::cout << "      >>>> airports expanded: " << plan.Expanded << std::endl;
+    if (!plan.Found)
+    {
+        std::cout << "> No route found between the given cities" << std::endl;
+        return;
     }
 
-    outputFileWriter(all_paths.begin()->second);
+    std::cout << "      >>>> solution path: " << Route::pathToString(planPath(plan), network.ids()) << " ]" << std::endl;
+    std::cout << "      >>>> haversine distance: " << plan.Distance << " km" << std::endl;
+    std::cout << std::endl;
+    outputFileWriter(plan, network.ids());
 }
 
 /**
- * @brief Writes the flight path to an output file.
- * @param flight_path The flight path to be written.
+ * @brief Writes the flight plan to an output file.
+ * @param plan The flight plan to be written.
+ * @param ids the airport ids of the network the plan was made in
  */
-void ReadWrite::outputFileWriter(const std::string flight_path)
+void ReadWrite::outputFileWriter(const FlightPlan &plan, const IataTable &ids)
 {
 
     std::string file = "//Users/admin/Library/CloudStorage/OneDrive-AshesiUniversity/Ashesi University/ashesi year 2/sem2/intermediate computer programming/AeroNav/flight_plan.txt";
@@ -240,29 +250,181 @@ void ReadWrite::outputFileWriter(const std::string flight_path)
     std::cout << std::endl;
     std::cout << "> Writing to output file..." << std::endl;
 
-    std::vector<std::string> output;
-    output = Route::stringToVec(flight_path);
+    writeFlightPlan(outputStream, plan, ids);
+    std::cout << "> Written to file!" << std::endl;
+}
 
-    // print to file
+/**
+ * @brief Writes the legs of a flight plan.
+ * Only reads the given ids, so plans can be written from several threads at once.
+ * @param outputStream the stream to write the flight plan to
+ * @param plan the flight plan, as returned by planFlight
+ * @param ids the airport ids of the network the plan was made in
+ */
+void ReadWrite::writeFlightPlan(std::ostream &outputStream, const FlightPlan &plan, const IataTable &ids)
+{
     outputStream << " >> Flight Plan <<" << std::endl
                  << std::endl;
-    for (int i = 1; i < output.size() - 1; i++)
+    for (std::size_t i = 0; i < plan.Legs.size(); i++)
+    {
+        const FlightLeg &leg = plan.Legs[i];
+        std::string airline = leg.Airline.isValid() ? leg.Airline.toString() : "(unknown)";
+        outputStream << "     " << i + 1 << ". flight " << airline << " from " << ids.code(leg.Source).toString()
+                     << " to " << ids.code(leg.Destination).toString() << " " << leg.Stops << " stops" << std::endl;
+    }
+    outputStream << "Total Flights: " << plan.Legs.size() << std::endl;
+    outputStream << "Total Additional Stops: " << plan.Stops << std::endl;
+}
+
+/**
+ * @brief Finds the codes of every airport in a city with one lookup in the city index of a network. Case and spacing of the names do not matter.
+ * @param network the network to look in
+ * @param city the name of the city
+ * @param country the name of the country the city is in
+ * @return the codes of the airports in the city, in code order
+ */
+std::vector<IataCode> ReadWrite::cityAirports(const Network &network, const std::string &city, const std::string &country)
+{
+    std::vector<IataCode> airports;
+    for (auto const &id : network.findCity(city, country))
     {
-        for (auto &pair : Route::AirlineRoutesMap)
+        airports.emplace_back(network.ids().code(id));
+    }
+    return airports;
+}
+
+/**
+ * @brief Plans the shortest flight between two cities.
+ * Uses no static state besides the search mode, so queries can be planned from several threads at once.
+ * @param network the network to plan in, pinned with Network::current
+ * @param query the start and destination cities
+ * @return the flight plan of the shortest route, not Found if either city has no airports or no route joins them
+ */
+FlightPlan ReadWrite::planFlight(const Network &network, const FlightQuery &query)
+{
+    SearchResult result = network.findShortestRoute(network.findCity(query.StartCity, query.StartCountry),
+                                                    network.findCity(query.DestinationCity, query.DestinationCountry), Search_Mode);
+    return FlightPlan::fromRoute(result, network.graph(), network.airlines());
+}
+
+/**
+ * @brief Plans the k shortest alternative flights between two cities, ranked by total distance.
+ * Like planFlight, can be called from several threads at once.
+ * @param network the network to plan in, pinned with Network::current
+ * @param query the start and destination cities
+ * @param k the number of alternatives to plan
+ * @return the flight plans of up to k distinct loopless routes, shortest first; empty if either city has no airports
+ * or no route joins them
+ */
+std::vector<FlightPlan> ReadWrite::planFlights(const Network &network, const FlightQuery &query, std::size_t k)
+{
+    std::vector<FlightPlan> plans;
+    for (auto const &result : network.findShortestRoutes(network.findCity(query.StartCity, query.StartCountry),
+                                                         network.findCity(query.DestinationCity, query.DestinationCountry), k))
+    {
+        plans.push_back(FlightPlan::fromRoute(result, network.graph(), network.airlines()));
+    }
+    return plans;
+}
+
+/**
+ * @brief Reads a file of many queries, plans them in parallel and writes every flight plan to one output file, in input order.
+ *
+ * The input file holds one query per pair of lines, in the same form as the single query input file: the start
+ * "city, country" on the first line and the destination "city, country" on the second. Blank lines are skipped.
+ * Every query is planned on a thread pool against the network pinned when the batch starts, so a reload meanwhile
+ * does not mix two networks in one output file.
+ *
+ * @param input_filename the file name of the batch input file
+ * @param output_filename the file name to write the flight plans to
+ * @param threads the number of threads to plan with, or 0 to use every hardware thread
+ * @return the number of queries planned, or 0 if the input file could not be read
+ */
+std::size_t ReadWrite::batchFileReader(const std::string &input_filename, const std::string &output_filename, unsigned threads)
+{
+    std::ifstream inputStream(input_filename);
+    if (!inputStream)
+    {
+        std::cout << "error opening/reading your file: check that input file is in right directory and the given file name matches" << std::endl;
+        return 0;
+    }
+    std::cout << std::endl;
+    std::cout << "> Reading batch file..." << std::endl;
+
+    // every place is "city, country"; places alternate between start and destination
+    std::vector<std::pair<std::string, std::string>> places;
+    std::string streamline;
+    std::string delimiter = ", ";
+    while (getline(inputStream, streamline))
+    {
+        if (!streamline.empty() && streamline.back() == '\r')
         {
-            if (pair.first[1] == output[i])
+            streamline.pop_back();
+        }
+        if (streamline.empty())
+        {
+            continue;
+        }
+        size_t pos = streamline.find(delimiter);
+        if (pos == std::string::npos)
+        {
+            places.emplace_back(streamline, "");
+        }
+        else
+        {
+            places.emplace_back(streamline.substr(0, pos), streamline.substr(pos + delimiter.length()));
+        }
+    }
+    inputStream.close();
+
+    std::vector<FlightQuery> queries;
+    for (size_t i = 0; i + 1 < places.size(); i += 2)
+    {
+        queries.push_back(FlightQuery{places[i].first, places[i].second, places[i + 1].first, places[i + 1].second});
+    }
+    std::cout << "> File read! " << queries.size() << " queries" << std::endl;
+
+    // each query writes only its own slot, so the plans come out in input order
+    std::shared_ptr<const Network> network = Network::current();
+    std::vector<std::string> plans(queries.size());
+    {
+        ThreadPool pool(threads);
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            pool.submit([&network, &queries, &plans, i]()
             {
-                std::string airline = pair.first[0];
-                std::string stops = pair.first[2];
-                outputStream << "     " << i << ". flight " << airline << " from " << output[i] << " to " << output[i + 1] << " " << stops << " stops" << std::endl;
-                break;
-            }
+                FlightPlan flight_plan = planFlight(*network, queries[i]);
+                std::ostringstream plan;
+                if (flight_plan.Found)
+                {
+                    writeFlightPlan(plan, flight_plan, network->ids());
+                    plan << "Total Distance: " << flight_plan.Distance << " km" << std::endl;
+                }
+                else
+                {
+                    plan << " >> No route found <<" << std::endl;
+                }
+                plans[i] = plan.str();
+            });
         }
+        pool.wait();
+    }
+
+    std::ofstream outputStream(output_filename);
+    if (!outputStream)
+    {
+        std::cout << "error writing batch output file: check that the output directory exists" << std::endl;
+        return 0;
+    }
+    std::cout << "> Writing to output file..." << std::endl;
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        outputStream << "Query " << i + 1 << ": " << queries[i].StartCity << ", " << queries[i].StartCountry << " -> "
+                     << queries[i].DestinationCity << ", " << queries[i].DestinationCountry << std::endl;
+        outputStream << plans[i] << std::endl;
     }
-    outputStream << "Total Flights: " << output.size() - 2 << std::endl;
-    outputStream << "Total Additional Stops: "
-                 << "1" << std::endl;
     std::cout << "> Written to file!" << std::endl;
+    return queries.size();
 }
 
 // int main()
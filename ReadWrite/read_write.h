@@ -9,6 +9,22 @@
 #include <sstream>
 #include <fstream>
 #include <iostream>
+#include "../Iata/iata.h"
+#include "../Search/route_search.h"
+#include "../Plan/flight_plan.h"
+#include "../Network/network.h"
+
+/**
+ * @struct FlightQuery
+ * @brief One request for a flight plan between two cities.
+ */
+struct FlightQuery
+{
+    std::string StartCity; /**< The city to depart from. */
+    std::string StartCountry; /**< The country of the start city. */
+    std::string DestinationCity; /**< The city to arrive at. */
+    std::string DestinationCountry; /**< The country of the destination city. */
+};
 
 /**
  * @class ReadWrite
@@ -24,6 +40,7 @@ private:
     static std::string StartCountry; /**< The start country a given flight. */
     static std::string Destination_City; /**< The destination city a given flight. */
     static std::string Destination_Country; /**< The destination country a given flight. */
+    static SearchMode Search_Mode; /**< The algorithm used to search for routes; the contraction hierarchy unless set otherwise. */
 
 public:
     /**
@@ -82,6 +99,20 @@ public:
      */
     static void setDestinationCountry(const std::string country);
 
+    /**
+     * @brief Retrieves the algorithm used to search for routes.
+     * 
+     * @return The search mode.
+     */
+    static SearchMode getSearchMode();
+
+    /**
+     * @brief Sets the algorithm used to search for routes.
+     * 
+     * @param mode The search mode to use.
+     */
+    static void setSearchMode(const SearchMode mode);
+
     /**
      * @brief Reads user input file containing start city and country, and destination city and country.
      * 
@@ -90,21 +121,76 @@ public:
     static void inputFileReader(const std::string &input_filename);
 
     /**
-     * @brief Calculates haversine distance between airports in a solution path and accumulates the values
-     * to obtain the total distance between the start and goal airports given a particular solution path.
-     * Passes solution path with lowest distance to outputFileWriter for file writing.
+     * @brief Finds the route with the smallest total haversine distance from any airport in the start city to any
+     * airport in the goal city, in a single search over every start and goal airport.
+     * Passes the flight plan to outputFileWriter for file writing.
      * 
-     * @param all_starts A string vector of the IATA codes of all airports in the given start city.
-     * @param all_goals A string vector of the IATA codes of all airports in the given goal city.
+     * @param network The network to plan in, pinned with Network::current.
+     * @param query The start and destination cities.
      */
-    static void haversineHelper(const std::vector<std::string> all_starts, const std::vector<std::string> all_goals);
+    static void haversineHelper(const Network &network, const FlightQuery &query);
 
     /**
      * @brief Writes the flight plan to an output file.
      * 
-     * @param flight_path The flight path to be written to the output file.
+     * @param plan The flight plan to be written to the output file.
+     * @param ids The airport ids of the network the plan was made in.
+     */
+    static void outputFileWriter(const FlightPlan &plan, const IataTable &ids);
+
+    /**
+     * @brief Writes the legs of a flight plan.
+     * Only reads the given ids, so plans can be written from several threads at once.
+     * 
+     * @param outputStream The stream to write the flight plan to.
+     * @param plan The flight plan, as returned by planFlight.
+     * @param ids The airport ids of the network the plan was made in.
+     */
+    static void writeFlightPlan(std::ostream &outputStream, const FlightPlan &plan, const IataTable &ids);
+
+    /**
+     * @brief Finds the codes of every airport in a city with one lookup in the city index of a network.
+     * Case and spacing of the names do not matter.
+     * 
+     * @param network The network to look in.
+     * @param city The name of the city.
+     * @param country The name of the country the city is in.
+     * @return The codes of the airports in the city, in code order.
+     */
+    static std::vector<IataCode> cityAirports(const Network &network, const std::string &city, const std::string &country);
+
+    /**
+     * @brief Plans the shortest flight between two cities.
+     * Uses no static state besides the search mode, so queries can be planned from several threads at once.
+     * 
+     * @param network The network to plan in, pinned with Network::current.
+     * @param query The start and destination cities.
+     * @return The flight plan of the shortest route, not Found if either city has no airports or no route joins them.
+     */
+    static FlightPlan planFlight(const Network &network, const FlightQuery &query);
+
+    /**
+     * @brief Plans the k shortest alternative flights between two cities, ranked by total distance.
+     * Like planFlight, can be called from several threads at once.
+     * 
+     * @param network The network to plan in, pinned with Network::current.
+     * @param query The start and destination cities.
+     * @param k The number of alternatives to plan.
+     * @return The flight plans of up to k distinct loopless routes, shortest first; empty if either city has no airports
+     * or no route joins them.
+     */
+    static std::vector<FlightPlan> planFlights(const Network &network, const FlightQuery &query, std::size_t k);
+
+    /**
+     * @brief Reads a file of many queries, plans them in parallel and writes every flight plan to one output file, in input order.
+     * Every query of the batch is planned in the same network, even if a reload publishes a new one meanwhile.
+     * 
+     * @param input_filename The file name of the batch input file: a start line and a destination line per query.
+     * @param output_filename The file name to write the flight plans to.
+     * @param threads The number of threads to plan with, or 0 to use every hardware thread.
+     * @return The number of queries planned, or 0 if the input file could not be read.
      */
-    static void outputFileWriter(const std::string flight_path);
+    static std::size_t batchFileReader(const std::string &input_filename, const std::string &output_filename, unsigned threads = 0);
 };
 
 #endif // READWRITE_H
@@ -5,11 +5,23 @@
 #include <deque>
 #include <queue>
 #include <vector>
+#include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <thread>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <unordered_set>
 #include "routes.h"
+#include "../Csv/csv_reader.h"
 #include "../Airports/airports.h"
+#include "../Mmap/mapped_file.h"
+#include "../ThreadPool/thread_pool.h"
 
 /**
  * @brief Default constructor for the Route class.
@@ -17,8 +29,8 @@
  */
 Route::Route()
 {
-    this->Source_AirportCode = "";
-    this->AirlineCode = "";
+    this->Source_AirportCode = IataCode();
+    this->AirlineCode = IataCode();
 }
 
 /**
@@ -27,7 +39,7 @@ Route::Route()
  * @param Destination_AirportCode The destination airport code.
  * @param airlineCode The airline code.
  */
-Route::Route(std::string Destination_AirportCode, std::string airlineCode)
+Route::Route(IataCode Destination_AirportCode, IataCode airlineCode)
 {
     this->Destination_AirportCode = Destination_AirportCode;
     this->AirlineCode = airlineCode;
@@ -36,9 +48,9 @@ Route::Route(std::string Destination_AirportCode, std::string airlineCode)
 /**
  * @brief Gets the source airport code.
  *
- * @return The source airport code as a string.
+ * @return The source airport code.
  */
-const std::string Route::getSA_Code() const
+IataCode Route::getSA_Code() const
 {
     return Source_AirportCode;
 }
@@ -46,9 +58,9 @@ const std::string Route::getSA_Code() const
 /**
  * @brief Get the Destination Airport Code.
  *
- * @return The destination airport code as a string.
+ * @return The destination airport code.
  */
-const std::string Route::getDA_Code() const
+IataCode Route::getDA_Code() const
 {
     return Destination_AirportCode;
 }
@@ -56,9 +68,9 @@ const std::string Route::getDA_Code() const
 /**
  * @brief Gets the airline code.
  *
- * @return The airline code as a string.
+ * @return The airline code.
  */
-const std::string Route::getAirline_Code() const
+IataCode Route::getAirline_Code() const
 {
     return AirlineCode;
 }
@@ -80,23 +92,63 @@ const std::string Route::getStops() const
  */
 const std::string Route::toString() const
 {
-    return "[ " + getDA_Code() + ", " + getAirline_Code() + " ]";
+    return "[ " + getDA_Code().toString() + ", " + getAirline_Code().toString() + " ]";
+}
+
+/**
+ * @brief Orders airline route keys by airline, then source airport, then stops.
+ *
+ * @param other The key to compare with.
+ * @return True if this key orders before the other key.
+ */
+bool AirlineRouteKey::operator<(const AirlineRouteKey &other) const
+{
+    if (Airline != other.Airline)
+    {
+        return Airline < other.Airline;
+    }
+    if (Source != other.Source)
+    {
+        return Source < other.Source;
+    }
+    return Stops < other.Stops;
 }
 
 /**
  * @brief A map that stores airport routes.
  *
- * This map associates a string key representing an airport with a vector of strings representing the routes from that airport.
+ * This map associates the code of an airport with the codes of the airports it has routes to.
  */
-std::map<std::string, std::vector<std::string>> Route::AirportRoutesMap;
+std::map<IataCode, std::vector<IataCode>> Route::AirportRoutesMap;
 
 /**
  * @brief A map that stores airline routes.
  *
- * This map associates a vector of strings representing the departure and arrival airports
- * with a vector of strings representing the airlines that operate the route.
+ * This map associates an airline, source airport and number of stops
+ * with the codes of the airports that airline flies to from that source airport.
+ */
+std::map<AirlineRouteKey, std::vector<IataCode>> Route::AirlineRoutesMap;
+
+/**
+ * @brief The route network in compressed sparse row form.
+ *
+ * Built from AirportRoutesMap once the route file has been read; queries read the copy in Network.
  */
-std::map<std::vector<std::string>, std::vector<std::string>> Route::AirlineRoutesMap;
+FlightGraph Route::RouteGraph;
+
+/**
+ * @brief The contraction hierarchy of RouteGraph.
+ *
+ * Built once the route graph has been measured, or loaded from the network snapshot.
+ */
+ContractionHierarchy Route::RouteHierarchy;
+
+/**
+ * @brief The airlines flying every route of RouteGraph.
+ *
+ * Built from AirlineRoutesMap once the route graph exists, and used to name the airline of every leg of a flight plan.
+ */
+AirlineIndex Route::RouteAirlines;
 
 /**
  * @brief Split a string by a delimiter and store values into a vector
@@ -107,16 +159,16 @@ std::vector<std::string> Route::stringToVec(std::string vector_string)
 {
     std::vector<std::string> output;
     std::string delimiter = ", ";
-    std::string substring;
+    size_t begin = 0;
     size_t pos = 0;
 
-    while ((pos = vector_string.find(delimiter)) != std::string::npos)
+    // walk the string instead of erasing each value from its front, which would copy the rest of it every time
+    while ((pos = vector_string.find(delimiter, begin)) != std::string::npos)
     {
-        substring = vector_string.substr(0, pos);
-        output.emplace_back(substring);
-        vector_string.erase(0, pos + delimiter.length());
+        output.emplace_back(vector_string, begin, pos - begin);
+        begin = pos + delimiter.length();
     }
-    output.emplace_back(vector_string);
+    output.emplace_back(vector_string, begin, std::string::npos);
     return output;
 }
 
@@ -142,153 +194,510 @@ std::string const Route::vecToString(std::vector<std::string> string_vector)
 }
 
 /**
- * @brief Reads an airport route file and creates a map of routes.
+ * @brief Convert codes in a vector into a single string
+ * @param code_vector  a vector of codes
+ * @return a single concatenated string of the vector values
+ */
+std::string const Route::vecToString(const std::vector<IataCode> &code_vector)
+{
+    std::stringstream stream;
+    stream << "[";
+    for (auto it = code_vector.begin(); it != code_vector.end(); it++)
+    {
+        if (it != code_vector.begin())
+        {
+            stream << ", ";
+        }
+        stream << it->toString();
+    }
+
+    return stream.str();
+}
+
+/**
+ * @brief The smallest share of a route file worth giving its own loader thread.
+ */
+const std::size_t Route::MinChunkBytes = 256 * 1024;
+
+/**
+ * @brief The number of airline keys turned into airline routes by one task of the thread pool.
+ */
+static const std::size_t KeysPerTask = 256;
+
+/**
+ * @brief Parses the rows of one chunk of a route file.
  *
- * This function reads a file containing airport routes and creates a map
- * where the keys are route keys and the values are vectors of destinations.
+ * Only the columns up to stops are split; the equipment column is never scanned. Rows that are not
+ * routes (the header row, short rows, rows with invalid airport codes) are skipped.
  *
- * @param filename The name of the file to read.
- * @return A map of routes, where the keys are route keys and the values are vectors of destinations.
+ * @param begin The first byte of the chunk.
+ * @param end One past the last byte of the chunk.
+ * @param chunk Receives the routes of the chunk; routes of each key are kept in file order.
  */
-std::map<std::string, std::vector<std::string>> Route::AirportRouteReader(std::string const &filename)
+void Route::parseRouteChunk(const char *begin, const char *end, RouteChunk &chunk)
 {
-    std::fstream inputStream;
-    inputStream.open(filename);
+    CsvReader reader(begin, end);
+    std::string_view streamline;
+    std::string_view splitline[8];
+    std::unordered_set<IataCode> seen;
 
-    if (inputStream)
+    while (reader.nextRow(streamline))
     {
-        // cout << "> file opened"<<endl;
-        std::vector<std::string> splitline;
-        std::string streamline, streamword, temp;
-
-        while (getline(inputStream, streamline))
+        if (CsvReader::splitFields(streamline, splitline, 8) < 8)
         {
-            splitline.clear();
-            std::stringstream line_of(streamline);
+            continue;
+        }
 
-            while (getline(line_of, streamword, ','))
-            {
-                splitline.push_back(streamword);
-            }
+        // skip the header row and rows without valid codes
+        AirlineRouteKey airlinekey;
+        airlinekey.Airline = IataCode::fromChars(splitline[0].data(), splitline[0].size()); // airline code
+        airlinekey.Source = IataCode::fromChars(splitline[2].data(), splitline[2].size());  // source airport
+        airlinekey.Stops = CsvReader::toInt(splitline[7]);                                  // stops
+        IataCode destination = IataCode::fromChars(splitline[4].data(), splitline[4].size());
+        if (!airlinekey.Source.isValid() || !destination.isValid())
+        {
+            continue;
+        }
 
-            // read into AirRoutesMap first
-            std::string routekey = splitline[2];
+        // airports are recorded source first, then destination, the order a single pass would intern them
+        if (seen.insert(airlinekey.Source).second)
+        {
+            chunk.NewAirports.push_back(airlinekey.Source);
+        }
+        if (seen.insert(destination).second)
+        {
+            chunk.NewAirports.push_back(destination);
+        }
 
-            if (AirportRoutesMap.count(routekey) > 0)
-            {
-                // key found
-                std::vector<std::string> routelist = AirportRoutesMap[splitline[2]];
-                routelist.emplace_back(splitline[4]);
-                AirportRoutesMap.erase(splitline[2]);
-                AirportRoutesMap.insert(std::pair<std::string, std::vector<std::string>>(routekey, routelist));
-            }
-            else
-            {
-                // key not found
-                std::vector<std::string> routelist;
-                routelist.emplace_back(splitline[4]);
-                AirportRoutesMap.insert(std::pair<std::string, std::vector<std::string>>(routekey, routelist));
-            }
+        chunk.AirportRoutes[airlinekey.Source].emplace_back(destination);
+        if (airlinekey.Airline.isValid())
+        {
+            chunk.AirlineRoutes[airlinekey].emplace_back(destination);
         }
-        inputStream.close();
-        std::cout << "> Airport-Route map created..." << std::endl;
     }
-    else
+}
+
+/**
+ * @brief Reads a route file once and builds every route index from it.
+ *
+ * The file is split into line-aligned chunks that are parsed in parallel. Each thread groups the rows of
+ * its chunk the same way the route maps do: by source airport for AirportRoutesMap and by (airline,
+ * source airport, stops) for AirlineRoutesMap. The chunks are then merged in file order by appending each
+ * group to the matching list, and their airports are interned in order of first appearance, so the maps,
+ * the airport ids and the order of every route list are the same as a single-threaded load would give.
+ * Once the file has been merged, AirportRoutesMap is packed into RouteGraph for use by the route search, and
+ * RouteAirlines is built, both on the same number of threads. Only the merge and the airport ids stay serial.
+ *
+ * @param filename The name of the file to read.
+ * @param threads The most threads to parse with, or 0 to use every hardware thread.
+ * @return True if the file was read, false if it could not be opened.
+ */
+bool Route::RouteFileReader(std::string const &filename, unsigned threads)
+{
+    MappedFile file;
+
+    if (!file.open(filename))
     {
         std::cout << "error opening/reading data file: check that the input file is in right directory and the given file name matches" << std::endl;
+        return false;
     }
 
-    return AirportRoutesMap;
+    // one chunk per thread, but no chunk smaller than MinChunkBytes
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::size_t chunkCount = std::min<std::size_t>(threads, file.size() / MinChunkBytes + 1);
+    std::vector<std::pair<const char *, const char *>> chunks = CsvReader::splitChunks(file.data(), file.data() + file.size(), chunkCount);
+
+    std::vector<RouteChunk> parsed(chunks.size());
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < chunks.size(); i++)
+    {
+        workers.emplace_back(parseRouteChunk, chunks[i].first, chunks[i].second, std::ref(parsed[i]));
+    }
+    if (!chunks.empty())
+    {
+        parseRouteChunk(chunks[0].first, chunks[0].second, parsed[0]);
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    // merge in file order so ids and route order match a single-threaded load
+    for (auto &chunk : parsed)
+    {
+        for (auto const &code : chunk.NewAirports)
+        {
+            Airport::AirportIds.intern(code);
+        }
+        for (auto &pair : chunk.AirportRoutes)
+        {
+            std::vector<IataCode> &routelist = AirportRoutesMap[pair.first];
+            routelist.insert(routelist.end(), pair.second.begin(), pair.second.end());
+        }
+        for (auto &pair : chunk.AirlineRoutes)
+        {
+            std::vector<IataCode> &routelist = AirlineRoutesMap[pair.first];
+            routelist.insert(routelist.end(), pair.second.begin(), pair.second.end());
+        }
+    }
+    std::cout << "> Airport-Route map created..." << std::endl;
+    std::cout << "> Airline-Route map created..." << std::endl;
+
+    RouteGraph = FlightGraph::fromRouteMap(AirportRoutesMap, Airport::AirportIds, threads);
+    std::cout << "> Route graph created..." << std::endl;
+    weighRouteGraph();
+    buildAirlineIndex(threads);
+
+    return true;
+}
+
+/**
+ * @brief Looks up the coordinates of every airport.
+ *
+ * @param airportCount The number of airports.
+ * @param latitudes Receives the latitude of every airport, indexed by id, or NaN if it has no coordinates.
+ * @param longitudes Receives the longitude of every airport, indexed by id, or NaN if it has no coordinates.
+ */
+static void airportPositions(std::uint32_t airportCount, std::vector<double> &latitudes, std::vector<double> &longitudes)
+{
+    latitudes.assign(airportCount, NAN);
+    longitudes.assign(airportCount, NAN);
+    for (std::uint32_t id = 0; id < airportCount && id < Airport::AirportsById.size(); id++)
+    {
+        const Airport *airport = Airport::AirportsById[id];
+        if (airport != nullptr)
+        {
+            latitudes[id] = airport->getLatitude();
+            longitudes[id] = airport->getLongitude();
+        }
+    }
 }
 
 /**
- * @brief Reads airline routes from a file and creates a map of routes.
+ * @brief Looks up the coordinates of the airports the changed rows of a route delta reach.
+ * A changed row is measured again as a whole, so its source needs a position, and so does every airport it flies
+ * to, before or after the delta; airports new to the graph need one for its search points. Every other entry is NaN.
  *
- * This function reads airline routes from a file specified by the filename parameter.
- * It creates a map where the keys are vectors of strings representing the airline code, source airport, and number of stops,
- * and the values are vectors of strings representing the destinations.
+ * @param airportCount The number of airports.
+ * @param changed The changed routes, as (source, destination) ids.
+ * @param latitudes Receives the latitude of the airports looked up, indexed by id, or NaN.
+ * @param longitudes Receives the longitude of the airports looked up, indexed by id, or NaN.
+ */
+static void changedPositions(std::uint32_t airportCount, const std::vector<std::pair<std::uint32_t, std::uint32_t>> &changed, std::vector<double> &latitudes, std::vector<double> &longitudes)
+{
+    latitudes.assign(airportCount, NAN);
+    longitudes.assign(airportCount, NAN);
+    auto lookUp = [&latitudes, &longitudes](std::uint32_t id)
+    {
+        const Airport *airport = id < Airport::AirportsById.size() ? Airport::AirportsById[id] : nullptr;
+        if (airport != nullptr)
+        {
+            latitudes[id] = airport->getLatitude();
+            longitudes[id] = airport->getLongitude();
+        }
+    };
+    for (auto const &route : changed)
+    {
+        lookUp(route.first);
+        lookUp(route.second);
+        if (route.first < Route::RouteGraph.airportCount())
+        {
+            std::for_each(Route::RouteGraph.successorsBegin(route.first), Route::RouteGraph.successorsEnd(route.first), lookUp);
+        }
+    }
+    for (std::uint32_t id = Route::RouteGraph.airportCount(); id < airportCount; id++)
+    {
+        lookUp(id);
+    }
+}
+
+/**
+ * @brief Removes the last occurrence of a code from a list of codes.
  *
- * @param filename The name of the file to read the airline routes from.
- * @return A map of airline routes, where the keys are vectors of strings and the values are vectors of strings.
+ * @param codes The list.
+ * @param code The code to remove.
+ * @return True if the code was found and removed, false if the list does not hold it.
  */
-std::map<std::vector<std::string>, std::vector<std::string>> Route::AirlineRouteReader(std::string const &filename)
+static bool eraseLast(std::vector<IataCode> &codes, IataCode code)
 {
+    auto found = std::find(codes.rbegin(), codes.rend(), code);
+    if (found == codes.rend())
+    {
+        return false;
+    }
+    codes.erase(std::next(found).base());
+    return true;
+}
 
-    std::fstream inputStream;
-    inputStream.open(filename);
-    // check if file exists
-    if (inputStream)
+/**
+ * @brief Reads a route delta file.
+ *
+ * Every row is a sign, then the airline, source airport, destination airport and stops of a route, such as
+ * "-,BA,LHR,JFK,0" to remove a row of the route file or "+,BA,LHR,EWR,0" to add one. Rows that do not start with a
+ * sign, such as a header row, are skipped; signed rows without a valid airline or airport code are skipped and counted.
+ *
+ * @param filename The name of the file to read from.
+ * @param delta Receives the rows to remove and add.
+ * @return True if the file was read, false if it could not be opened.
+ */
+bool Route::RouteDeltaReader(const std::string &filename, RouteDelta &delta)
+{
+    MappedFile file;
+    if (!file.open(filename))
     {
-        std::vector<std::string> splitline;
-        std::string streamline, streamword, temp;
+        std::cout << "error opening/reading route delta file: check that the delta file is in right directory and the given file name matches" << std::endl;
+        return false;
+    }
 
-        while (getline(inputStream, streamline))
+    CsvReader reader(file.data(), file.data() + file.size());
+    std::string_view streamline;
+    std::string_view splitline[5];
+    std::size_t skipped = 0;
+    while (reader.nextRow(streamline))
+    {
+        std::size_t fields = CsvReader::splitFields(streamline, splitline, 5);
+        if (fields < 1 || (splitline[0] != "+" && splitline[0] != "-"))
+        {
+            continue;
+        }
+        RouteRow row{IataCode(), IataCode(), IataCode(), 0};
+        if (fields == 5)
         {
-            splitline.clear();
-            std::stringstream line_of(streamline);
+            row.Airline = IataCode::fromChars(splitline[1].data(), splitline[1].size());
+            row.Source = IataCode::fromChars(splitline[2].data(), splitline[2].size());
+            row.Destination = IataCode::fromChars(splitline[3].data(), splitline[3].size());
+            row.Stops = CsvReader::toInt(splitline[4]);
+        }
+        if (!row.Airline.isValid() || !row.Source.isValid() || !row.Destination.isValid())
+        {
+            skipped++;
+            continue;
+        }
+        (splitline[0] == "+" ? delta.Added : delta.Removed).push_back(row);
+    }
 
-            while (getline(line_of, streamword, ','))
-            {
-                splitline.push_back(streamword);
-            }
-            // read into RouteAirlineMap
-            std::vector<std::string> routekey2;
-            routekey2.emplace_back(splitline[0]); // airline code
-            routekey2.emplace_back(splitline[2]); // source airport
-            routekey2.emplace_back(splitline[7]); // stops
+    std::cout << "> Route delta read: " << delta.Removed.size() << " rows to remove, " << delta.Added.size() << " to add..." << std::endl;
+    if (skipped > 0)
+    {
+        std::cout << "  >> skipped " << skipped << " rows without a valid airline or airport code" << std::endl;
+    }
+    return true;
+}
 
-            if (AirlineRoutesMap.find(routekey2) != AirlineRoutesMap.end())
-            {
-                // key found
-                std::vector<std::string> routelist = AirlineRoutesMap[routekey2];
-                routelist.emplace_back(splitline[4]);
-                AirlineRoutesMap.erase(routekey2);
-                AirlineRoutesMap.insert(std::pair<std::vector<std::string>, std::vector<std::string>>(routekey2, routelist));
-            }
-            else
+/**
+ * @brief Applies a route delta to the route maps, RouteGraph and RouteAirlines.
+ *
+ * Removed rows are taken out of their lists in AirportRoutesMap and AirlineRoutesMap and added rows appended, as if
+ * the route file had been edited and loaded again; codes new to the network are interned in the order a load would
+ * meet them after every existing row. Only the routes the delta names are then looked at: a route joins the graph
+ * when its first row is added and leaves it when its last row is removed, and its airlines are those of the remaining
+ * rows. Only the changed rows are measured again, and only the airports they reach are looked up.
+ *
+ * The packed arrays cannot be changed in place, so they are rebuilt, and those passes grow with the network, not
+ * with the delta: FlightGraph::withRoutes copies every row and rebuilds the reverse rows, and AirlineIndex::update
+ * copies every route's airlines and rewrites every offset. They are plain copies, each about a millisecond for the
+ * OpenFlights network, against the seconds of a full load; searching the maps is the only work that grows with the
+ * delta alone.
+ *
+ * A removed row is taken from the end of its lists, so duplicate rows may end up in another order than a load of the
+ * edited file gives them; nothing built from the maps depends on that order. An airport only named by the route file
+ * keeps its id, even if the delta removes its every row.
+ *
+ * @param delta The rows to remove and add; removed rows that are not in the network are ignored.
+ */
+void Route::applyRouteDelta(const RouteDelta &delta)
+{
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> changed;
+    std::size_t missing = 0;
+    for (auto const &row : delta.Removed)
+    {
+        auto airlineRoutes = AirlineRoutesMap.find(AirlineRouteKey{row.Airline, row.Source, row.Stops});
+        auto airportRoutes = AirportRoutesMap.find(row.Source);
+        if (airlineRoutes == AirlineRoutesMap.end() || airportRoutes == AirportRoutesMap.end() || !eraseLast(airlineRoutes->second, row.Destination))
+        {
+            missing++;
+            continue;
+        }
+        eraseLast(airportRoutes->second, row.Destination);
+        if (airlineRoutes->second.empty())
+        {
+            AirlineRoutesMap.erase(airlineRoutes);
+        }
+        if (airportRoutes->second.empty())
+        {
+            AirportRoutesMap.erase(airportRoutes);
+        }
+        changed.emplace_back(Airport::AirportIds.find(row.Source), Airport::AirportIds.find(row.Destination));
+    }
+    for (auto const &row : delta.Added)
+    {
+        // source first, then destination, the order a load interns them
+        std::uint32_t source = Airport::AirportIds.intern(row.Source);
+        std::uint32_t destination = Airport::AirportIds.intern(row.Destination);
+        AirportRoutesMap[row.Source].push_back(row.Destination);
+        AirlineRoutesMap[AirlineRouteKey{row.Airline, row.Source, row.Stops}].push_back(row.Destination);
+        changed.emplace_back(source, destination);
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    // a changed route is in the new graph if any row still flies it; its airlines are the candidates still flying it
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> addedRoutes;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> removedRoutes;
+    std::vector<AirlineRoute> candidates;
+    for (auto const &route : changed)
+    {
+        IataCode source = Airport::AirportIds.code(route.first);
+        IataCode destination = Airport::AirportIds.code(route.second);
+        auto airportRoutes = AirportRoutesMap.find(source);
+        bool flown = airportRoutes != AirportRoutesMap.end() && std::find(airportRoutes->second.begin(), airportRoutes->second.end(), destination) != airportRoutes->second.end();
+        std::uint32_t edge = RouteGraph.findEdge(route.first, route.second);
+        if (flown && edge == IataTable::NoId)
+        {
+            addedRoutes.push_back(route);
+        }
+        if (!flown && edge != IataTable::NoId)
+        {
+            removedRoutes.push_back(route);
+        }
+        if (edge != IataTable::NoId && edge < RouteAirlines.routeCount())
+        {
+            for (const EdgeAirline *airline = RouteAirlines.airlinesBegin(edge); airline != RouteAirlines.airlinesEnd(edge); airline++)
             {
-                // key not found
-                std::vector<std::string> routelist = AirlineRoutesMap[routekey2];
-                routelist.emplace_back(splitline[4]);
-                AirlineRoutesMap.insert(std::pair<std::vector<std::string>, std::vector<std::string>>(routekey2, routelist));
+                candidates.push_back(AirlineRoute{route.first, route.second, *airline});
             }
         }
-        inputStream.close();
-        std::cout << "> Airline-Route map created..." << std::endl;
     }
-    else
+    for (auto const &row : delta.Added)
     {
-        std::cout << "error opening/reading data file: check that the input file is in right directory and the given file name matches" << std::endl;
+        candidates.push_back(AirlineRoute{Airport::AirportIds.find(row.Source), Airport::AirportIds.find(row.Destination), EdgeAirline{row.Airline, row.Stops}});
+    }
+    std::vector<AirlineRoute> airlines;
+    for (auto const &candidate : candidates)
+    {
+        auto airlineRoutes = AirlineRoutesMap.find(AirlineRouteKey{candidate.Operator.Airline, Airport::AirportIds.code(candidate.Source), candidate.Operator.Stops});
+        if (airlineRoutes != AirlineRoutesMap.end() &&
+            std::find(airlineRoutes->second.begin(), airlineRoutes->second.end(), Airport::AirportIds.code(candidate.Destination)) != airlineRoutes->second.end())
+        {
+            airlines.push_back(candidate);
+        }
     }
 
-    return AirlineRoutesMap;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    changedPositions(Airport::AirportIds.size(), changed, latitudes, longitudes);
+    FlightGraph graph = RouteGraph.withRoutes(Airport::AirportIds.size(), addedRoutes, removedRoutes, latitudes, longitudes);
+    RouteAirlines = AirlineIndex::update(graph, RouteGraph, RouteAirlines, changed, airlines);
+    RouteGraph = std::move(graph);
+    RouteHierarchy = ContractionHierarchy();
+
+    std::cout << "> Route delta applied: " << addedRoutes.size() << " routes added, " << removedRoutes.size() << " removed..." << std::endl;
+    if (missing > 0)
+    {
+        std::cout << "  >> ignored " << missing << " removed rows that are not in the network" << std::endl;
+    }
 }
 
 /**
- * @brief Prints the contents of a map, where the keys are strings and the values are vectors of strings.
+ * @brief Measures every route of RouteGraph using the coordinates in Airport::AirportMap.
+ *
+ * Airports that only appear in the route data, or whose coordinates did not parse, have no position, so
+ * their routes are left unmeasured and are never used by a distance search.
+ */
+void Route::weighRouteGraph()
+{
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    airportPositions(RouteGraph.airportCount(), latitudes, longitudes);
+    RouteGraph.weighRoutes(latitudes, longitudes);
+    std::cout << "> Route distances measured..." << std::endl;
+}
+
+/**
+ * @brief Builds RouteAirlines from AirlineRoutesMap and RouteGraph.
+ * The rows of every airline key are turned into airline routes on the thread pool, each key writing its own slice
+ * of the list, before AirlineIndex::build indexes them.
+ *
+ * @param threads The number of threads to build with, or 0 to use every hardware thread.
+ */
+void Route::buildAirlineIndex(unsigned threads)
+{
+    std::vector<const std::pair<const AirlineRouteKey, std::vector<IataCode>> *> keys;
+    std::vector<std::size_t> begins;
+    std::size_t total = 0;
+    keys.reserve(AirlineRoutesMap.size());
+    begins.reserve(AirlineRoutesMap.size());
+    for (auto const &pair : AirlineRoutesMap)
+    {
+        keys.push_back(&pair);
+        begins.push_back(total);
+        total += pair.second.size();
+    }
+
+    std::vector<AirlineRoute> routes(total);
+    {
+        ThreadPool pool(threads);
+        for (std::size_t first = 0; first < keys.size(); first += KeysPerTask)
+        {
+            pool.submit([&keys, &begins, &routes, first]()
+                        {
+                            std::size_t last = std::min(keys.size(), first + KeysPerTask);
+                            for (std::size_t k = first; k < last; k++)
+                            {
+                                const AirlineRouteKey &key = keys[k]->first;
+                                std::uint32_t source = Airport::AirportIds.find(key.Source);
+                                std::size_t slot = begins[k];
+                                for (auto const &destination : keys[k]->second)
+                                {
+                                    routes[slot++] = AirlineRoute{source, Airport::AirportIds.find(destination), EdgeAirline{key.Airline, key.Stops}};
+                                }
+                            } });
+        }
+        pool.wait();
+    }
+    RouteAirlines = AirlineIndex::build(RouteGraph, routes, threads);
+    std::cout << "> Route airlines indexed..." << std::endl;
+}
+
+/**
+ * @brief Builds RouteHierarchy from the measured RouteGraph.
+ * Takes a few seconds; the result is saved in the network snapshot so it is only rebuilt when the data files change.
+ */
+void Route::buildRouteHierarchy()
+{
+    RouteHierarchy = ContractionHierarchy::build(RouteGraph);
+    std::cout << "> Route hierarchy created..." << std::endl;
+}
+
+/**
+ * @brief Prints the contents of a map, where the keys are codes and the values are vectors of codes.
  *
  * @param thisMap The map to be printed.
  */
-void Route::printMap(std::map<std::string, std::vector<std::string>> thisMap)
+void Route::printMap(const std::map<IataCode, std::vector<IataCode>> &thisMap)
 {
     for (auto &pair : thisMap)
     {
-        std::cout << "[" << pair.first << "]"
+        std::cout << "[" << pair.first.toString() << "]"
                   << " >> " << vecToString(pair.second) << std::endl;
         std::cout << std::endl;
     }
 }
 
 /**
- * @brief Prints the contents of a map, where the keys and values are vectors of strings.
+ * @brief Prints the contents of a map, where the keys are airline route keys and the values are vectors of codes.
  *
  * @param thisMap The map to be printed.
  */
-void Route::printMap(std::map<std::vector<std::string>, std::vector<std::string>> thisMap)
+void Route::printMap(const std::map<AirlineRouteKey, std::vector<IataCode>> &thisMap)
 {
     for (auto &pair : thisMap)
     {
-        std::cout << vecToString(pair.first) << "] >> " << vecToString(pair.second) << "]" << std::endl;
+        std::cout << "[" << pair.first.Airline.toString() << ", " << pair.first.Source.toString() << ", " << pair.first.Stops
+                  << "] >> " << vecToString(pair.second) << "]" << std::endl;
     }
 }
 
@@ -298,9 +707,9 @@ void Route::printMap(std::map<std::vector<std::string>, std::vector<std::string>
  * @param value a string
  * @return true if deque contains element and false if otherwise
  */
-bool Route::contains(std::deque<std::string> deq, std::string value)
+bool Route::contains(const std::deque<std::string> &deq, const std::string &value)
 {
-    std::deque<std::string>::iterator itr;
+    std::deque<std::string>::const_iterator itr;
     itr = find(deq.begin(), deq.end(), value);
     if (itr != deq.end())
     {
@@ -316,7 +725,7 @@ bool Route::contains(std::deque<std::string> deq, std::string value)
  * @param value a string
  * @return true if vector contains element and false if otherwise
  */
-bool Route::contains(std::vector<std::string> vec, std::string value)
+bool Route::contains(const std::vector<std::string> &vec, const std::string &value)
 {
     if (std::find(vec.begin(), vec.end(), value) != vec.end())
     {
@@ -329,80 +738,19 @@ bool Route::contains(std::vector<std::string> vec, std::string value)
 }
 
 /**
- * @brief Find a given goal airport from a start airport using airport iata codes
- * @param start_airport the iata code of a start airport
- * @param goal_airport the iata code of a goal airport
- * @return string of iata codes of found solution path containing all connected airports between start airport and goal airport
- */
-std::string Route::findRoute(std::string start_airport, std::string goal_airport)
-{
-
-    std::map<std::string, std::string> child_parent;
-    std::cout << "  >> start airport: " << start_airport << std::endl;
-    std::cout << "  >> goal airport: " << goal_airport << std::endl;
-    std::cout << "     >>> searching..." << std::endl;
-
-    std::deque<std::string> frontier;
-    frontier.emplace_back(start_airport);
-    std::vector<std::string> explored_set;
-    std::vector<std::string> key;
-
-    while (!frontier.empty())
-    {
-        std::string parent = frontier.front();
-        frontier.pop_front();
-        child_parent.insert(std::pair<std::string, std::string>(parent, ""));
-        explored_set.emplace_back(parent);
-        std::vector<std::string> successors = AirportRoutesMap[parent];
-
-        if (!successors.empty())
-        {
-            for (int i = 0; i < successors.size(); i++)
-            {
-                std::string child = successors[i];
-                child_parent.insert(std::pair<std::string, std::string>(child, parent));
-                if (!contains(explored_set, child) && (!contains(frontier, child)))
-                {
-                    if (child.compare(goal_airport) == 0)
-                    {
-                        std::string solution = solution_path(child_parent, child);
-                        return solution;
-                    }
-                }
-                frontier.emplace_back(child);
-            }
-        }
-        else
-        {
-            std::cout << "no route from this airport: " << std::endl;
-            break;
-        }
-    }
-    return NULL;
-}
-
-/**
- * @brief Find solution path by connecting each airport iata code to its given parent
- * @param solution_map  a map of parent-child relationships between all airports explored during the search. keys are iata codes of child states and values are iata codes of parent states.
- * @param child  the goal airport iata code, the last child discovered during the search
- * @return concatenated string of all connected nodes from start aiport to goal airport
+ * @brief Converts a path of airport ids into a string of IATA codes.
+ * @param path  the ids of the airports on the path, start first
+ * @param ids  the airport ids of the network the path was found in
+ * @return concatenated string of all airports on the path
  */
-std::string Route::solution_path(std::map<std::string, std::string> solution_map, std::string child)
+std::string Route::pathToString(const std::vector<std::uint32_t> &path, const IataTable &ids)
 {
     std::vector<std::string> solution_path;
-    solution_path.emplace_back(child);
-    std::string parent = solution_map[child];
-    solution_path.emplace_back(parent);
-
-    while (parent != "")
+    solution_path.emplace_back("");
+    for (auto const &id : path)
     {
-        child = parent;
-        parent = solution_map[child];
-        solution_path.emplace_back(parent);
+        solution_path.emplace_back(ids.code(id).toString());
     }
-    reverse(solution_path.begin(), solution_path.end());
-    std::cout << "      >>>> solution path: " << vecToString(solution_path) << " ]" << std::endl;
-
     return vecToString(solution_path);
 }
 
@@ -8,6 +8,60 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include "../Iata/iata.h"
+#include "../Graph/flight_graph.h"
+#include "../Graph/airline_index.h"
+#include "../Search/route_search.h"
+#include "../Hierarchy/contraction_hierarchy.h"
+
+/**
+ * @struct AirlineRouteKey
+ * @brief Identifies the routes an airline flies out of an airport with a given number of stops.
+ */
+struct AirlineRouteKey
+{
+    IataCode Airline; /**< The code of the airline operating the routes. */
+    IataCode Source; /**< The code of the source airport. */
+    int Stops; /**< The number of stops on the routes. */
+
+    /**
+     * @brief Orders keys by airline, then source airport, then stops.
+     */
+    bool operator<(const AirlineRouteKey &other) const;
+};
+
+/**
+ * @struct RouteChunk
+ * @brief The routes parsed from one line-aligned chunk of a route file, ready to be merged into the route maps.
+ */
+struct RouteChunk
+{
+    std::vector<IataCode> NewAirports; /**< Every airport of the chunk, in order of first appearance. */
+    std::map<IataCode, std::vector<IataCode>> AirportRoutes; /**< The routes of the chunk, grouped like AirportRoutesMap. */
+    std::map<AirlineRouteKey, std::vector<IataCode>> AirlineRoutes; /**< The routes of the chunk, grouped like AirlineRoutesMap. */
+};
+
+/**
+ * @struct RouteRow
+ * @brief One row of a route file, reduced to the columns the route maps keep.
+ */
+struct RouteRow
+{
+    IataCode Airline; /**< The code of the airline operating the route. */
+    IataCode Source; /**< The code of the source airport. */
+    IataCode Destination; /**< The code of the destination airport. */
+    int Stops; /**< The number of stops on the route. */
+};
+
+/**
+ * @struct RouteDelta
+ * @brief The rows to remove from and add to the route file, as read from a route delta file.
+ */
+struct RouteDelta
+{
+    std::vector<RouteRow> Removed; /**< The rows to remove, in file order. */
+    std::vector<RouteRow> Added; /**< The rows to add, in file order. */
+};
 
 /**
  * @class Route
@@ -20,9 +74,25 @@
 class Route{
 
 private:
-    std::string Source_AirportCode; /**< The code of the source airport. */
-    std::string Destination_AirportCode; /**< The code of the destination airport. */
-    std::string AirlineCode; /**< The code of the airline operating the route. */
+    /**
+     * @brief The smallest share of a route file worth giving its own loader thread.
+     */
+    static const std::size_t MinChunkBytes;
+
+    /**
+     * @brief Parses the rows of one chunk of a route file.
+     *
+     * Rows that are not routes (the header row, short rows, rows with invalid airport codes) are skipped.
+     *
+     * @param begin The first byte of the chunk.
+     * @param end One past the last byte of the chunk.
+     * @param chunk Receives the routes of the chunk; routes of each key are kept in file order.
+     */
+    static void parseRouteChunk(const char *begin, const char *end, RouteChunk &chunk);
+
+    IataCode Source_AirportCode; /**< The code of the source airport. */
+    IataCode Destination_AirportCode; /**< The code of the destination airport. */
+    IataCode AirlineCode; /**< The code of the airline operating the route. */
     std::string Stops; /**< The number of stops in the route. */
 
 public:
@@ -37,28 +107,28 @@ public:
      * @param Destination_AirportCode The code of the destination airport.
      * @param airlineCode The code of the airline operating the route.
      */
-    Route(std::string Destination_AirportCode, std::string airlineCode);
+    Route(IataCode Destination_AirportCode, IataCode airlineCode);
 
     /**
      * @brief Retrieves the source airport code associated with the route.
      *
-     * @return The source airport code as a string.
+     * @return The source airport code.
      */
-    const std::string getSA_Code() const;
+    IataCode getSA_Code() const;
 
     /**
      * @brief Retrieves the destination airport code associated with the route.
      *
-     * @return The destination airport code as a string.
+     * @return The destination airport code.
      */
-    const std::string getDA_Code() const;
+    IataCode getDA_Code() const;
 
     /**
      * @brief Retrieves the airline code associated with the route.
      *
-     * @return The airline code as a string.
+     * @return The airline code.
      */
-    const std::string getAirline_Code() const;
+    IataCode getAirline_Code() const;
 
     /**
      * @brief Retrieves the number of stops in the route.
@@ -77,12 +147,27 @@ public:
     /**
      * @brief A map that stores the routes for each airport.
      */
-    static std::map<std::string, std::vector<std::string>> AirportRoutesMap;
+    static std::map<IataCode, std::vector<IataCode>> AirportRoutesMap;
 
     /**
      * @brief A map that stores the routes for each airline.
      */
-    static std::map<std::vector<std::string>, std::vector<std::string>> AirlineRoutesMap;
+    static std::map<AirlineRouteKey, std::vector<IataCode>> AirlineRoutesMap;
+
+    /**
+     * @brief The route network in compressed sparse row form; queries read the copy in Network.
+     */
+    static FlightGraph RouteGraph;
+
+    /**
+     * @brief The contraction hierarchy of RouteGraph, used by SearchMode::Hierarchy searches.
+     */
+    static ContractionHierarchy RouteHierarchy;
+
+    /**
+     * @brief The airlines flying every route of RouteGraph, with their stops.
+     */
+    static AirlineIndex RouteAirlines;
 
     /**
      * @brief Converts a string representation of a vector to a vector of strings.
@@ -101,34 +186,88 @@ public:
     static std::string const vecToString(std::vector<std::string> string_vector);
 
     /**
-     * @brief Reads the airport routes from a file and returns a map of airport codes and their routes.
+     * @brief Converts a vector of codes to a string representation.
+     *
+     * @param code_vector The vector of codes.
+     * @return The string representation of the vector.
+     */
+    static std::string const vecToString(const std::vector<IataCode> &code_vector);
+
+    /**
+     * @brief Reads a route file once and fills AirportRoutesMap, AirlineRoutesMap and RouteGraph from it.
+     *
+     * Large files are split into line-aligned chunks that are parsed on separate threads; the result is the
+     * same as a single-threaded load.
      *
      * @param filename The name of the file to read from.
-     * @return A map of airport codes and their routes.
+     * @param threads The most threads to parse with, or 0 to use every hardware thread.
+     * @return True if the file was read, false if it could not be opened.
      */
-    static std::map<std::string, std::vector<std::string>> AirportRouteReader(const std::string &filename);
+    static bool RouteFileReader(const std::string &filename, unsigned threads = 0);
 
     /**
-     * @brief Reads the airline routes from a file and returns a map of airline codes and their routes.
+     * @brief Reads a route delta file.
+     * Every row is "+" or "-" followed by the airline, source airport, destination airport and stops of a route;
+     * rows that do not start with a sign, such as a header row, are skipped.
      *
      * @param filename The name of the file to read from.
-     * @return A map of airline codes and their routes.
+     * @param delta Receives the rows to remove and add.
+     * @return True if the file was read, false if it could not be opened.
+     */
+    static bool RouteDeltaReader(const std::string &filename, RouteDelta &delta);
+
+    /**
+     * @brief Applies a route delta to the route maps, RouteGraph and RouteAirlines.
+     * Only the changed routes are looked up and measured again, but the packed arrays of the graph and the airline
+     * index are copied whole, so the time still grows with the network, at the speed of a copy. The result is the same as loading the route file with the removed rows taken out and the added rows appended,
+     * except that an airport only named by the route file keeps its id. RouteHierarchy no longer matches the changed
+     * graph, so it is cleared.
+     *
+     * @param delta The rows to remove and add; removed rows that are not in the network are ignored.
+     */
+    static void applyRouteDelta(const RouteDelta &delta);
+
+    /**
+     * @brief Measures every route of RouteGraph using the coordinates in Airport::AirportMap.
+     * Must run after the airports and routes are loaded, before any distance search.
+     */
+    static void weighRouteGraph();
+
+    /**
+     * @brief Builds RouteAirlines from AirlineRoutesMap and RouteGraph.
+     *
+     * @param threads The number of threads to build with, or 0 to use every hardware thread.
+     */
+    static void buildAirlineIndex(unsigned threads = 0);
+
+    /**
+     * @brief Builds RouteHierarchy from the measured RouteGraph.
+     * Takes a few seconds; the result is saved in the network snapshot so it is only rebuilt when the data files change.
+     */
+    static void buildRouteHierarchy();
+
+    /**
+     * @brief Converts a path of airport ids into a string of IATA codes.
+     *
+     * @param path The ids of the airports on the path, start first.
+     * @param ids The airport ids of the network the path was found in.
+     * @return concatenated string of all airports on the path
      */
-    static std::map<std::vector<std::string>, std::vector<std::string>> AirlineRouteReader(const std::string &filename);
+    static std::string pathToString(const std::vector<std::uint32_t> &path, const IataTable &ids);
 
     /**
      * @brief Prints the contents of a map of airport routes.
      *
      * @param thisMap The map of airport routes.
      */
-    static void printMap(std::map<std::string, std::vector<std::string>> thisMap);
+    static void printMap(const std::map<IataCode, std::vector<IataCode>> &thisMap);
 
     /**
      * @brief Prints the contents of a map of airline routes.
      *
      * @param thisMap The map of airline routes.
      */
-    static void printMap(std::map<std::vector<std::string>, std::vector<std::string>> thisMap);
+    static void printMap(const std::map<AirlineRouteKey, std::vector<IataCode>> &thisMap);
 
     /**
      * @brief Checks if a deque contains a specific value.
@@ -137,7 +276,7 @@ public:
      * @param value The value to search for.
      * @return True if the deque contains the value, false otherwise.
      */
-    static bool contains(std::deque<std::string> deq, std::string value);
+    static bool contains(const std::deque<std::string> &deq, const std::string &value);
 
     /**
      * @brief Checks if a vector contains a specific value.
@@ -146,25 +285,7 @@ public:
      * @param value The value to search for.
      * @return True if the vector contains the value, false otherwise.
      */
-    static bool contains(std::vector<std::string> vec, std::string value);
-
-    /**
-     * @brief Finds a route between two airports.
-     *
-     * @param start_airport The code of the starting airport.
-     * @param goal_airport The code of the destination airport.
-     * @return The route between the two airports as a string.
-     */
-    static std::string findRoute(std::string start_airport, std::string goal_airport);
-
-    /**
-     * @brief Constructs the solution path for a route.
-     *
-     * @param solution_map The map containing the solution path.
-     * @param child The child node of the solution path.
-     * @return The solution path as a string.
-     */
-    static std::string solution_path(std::map<std::string, std::string> solution_map, std::string child);
+    static bool contains(const std::vector<std::string> &vec, const std::string &value);
 };
 
 #endif // ROUTES_H
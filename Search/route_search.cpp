@@ -0,0 +1,623 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <limits>
+#include <set>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include "route_search.h"
+#include "../Iata/iata.h"
+
+/**
+ * @brief Sizes a workspace for a graph and starts a new search generation, unblocking every airport and route.
+ * The stamps are only cleared when the generation counter wraps around.
+ *
+ * @param graph The route graph the next search runs on.
+ * @param workspace The workspace to prepare.
+ */
+void RouteSearch::beginSearch(const FlightGraph &graph, SearchWorkspace &workspace)
+{
+    if (workspace.Reached.size() != graph.airportCount() || workspace.BlockedRoutes.size() != graph.routeCount())
+    {
+        workspace.Distances.assign(graph.airportCount(), 0);
+        workspace.Parents.assign(graph.airportCount(), IataTable::NoId);
+        workspace.Reached.assign(graph.airportCount(), 0);
+        workspace.Blocked.assign(graph.airportCount(), 0);
+        workspace.BlockedRoutes.assign(graph.routeCount(), 0);
+        workspace.Remaining.assign(graph.airportCount(), 0);
+        workspace.Estimated.assign(graph.airportCount(), 0);
+        workspace.IsGoal.assign(graph.airportCount(), 0);
+        workspace.BackwardDistances.assign(graph.airportCount(), 0);
+        workspace.BackwardParents.assign(graph.airportCount(), IataTable::NoId);
+        workspace.BackwardReached.assign(graph.airportCount(), 0);
+        workspace.Targets.clear();
+        workspace.Generation = 0;
+        workspace.GoalGeneration = 0;
+    }
+    if (++workspace.Generation == 0)
+    {
+        std::fill(workspace.Reached.begin(), workspace.Reached.end(), 0);
+        std::fill(workspace.BackwardReached.begin(), workspace.BackwardReached.end(), 0);
+        std::fill(workspace.Blocked.begin(), workspace.Blocked.end(), 0);
+        std::fill(workspace.BlockedRoutes.begin(), workspace.BlockedRoutes.end(), 0);
+        workspace.Generation = 1;
+    }
+    workspace.Heap.clear();
+    workspace.BackwardHeap.clear();
+    workspace.Queue.clear();
+    workspace.BackwardQueue.clear();
+}
+
+/**
+ * @brief Gets the workspace of the calling thread, with a new search begun on a graph.
+ * The workspace lives as long as the thread, so once its arrays have grown to the size of the graph a search
+ * allocates nothing beyond its result.
+ *
+ * @param graph The route graph the next search runs on.
+ * @return The workspace of the calling thread.
+ */
+SearchWorkspace &RouteSearch::threadWorkspace(const FlightGraph &graph)
+{
+    static thread_local SearchWorkspace workspace;
+    beginSearch(graph, workspace);
+    return workspace;
+}
+
+/**
+ * @brief Sets the goals of the following searches, dropping the distance estimates made for earlier goals.
+ * Ids that are not in the graph (such as IataTable::NoId for unknown airports) are ignored.
+ *
+ * @param graph The route graph, after beginSearch has sized the workspace for it.
+ * @param workspace The workspace of the searches.
+ * @param goals The ids of the airports the routes may end at.
+ */
+void RouteSearch::setGoals(const FlightGraph &graph, SearchWorkspace &workspace, const std::vector<std::uint32_t> &goals)
+{
+    if (++workspace.GoalGeneration == 0)
+    {
+        std::fill(workspace.Estimated.begin(), workspace.Estimated.end(), 0);
+        std::fill(workspace.IsGoal.begin(), workspace.IsGoal.end(), 0);
+        workspace.GoalGeneration = 1;
+    }
+    workspace.Targets.clear();
+    for (auto const &goal : goals)
+    {
+        if (goal < graph.airportCount() && workspace.IsGoal[goal] != workspace.GoalGeneration)
+        {
+            workspace.IsGoal[goal] = workspace.GoalGeneration;
+            workspace.Targets.push_back(goal);
+        }
+    }
+}
+
+/**
+ * @brief Runs a best-first search for the shortest route from any start airport to any goal airport, with or
+ * without the great-circle heuristic.
+ *
+ * Every start airport is seeded at distance 0, so one search covers them all. Airports wait in a binary heap
+ * keyed by their tentative distance from the nearest start, plus, for A*, a quick lower bound on the great-circle
+ * distance to the nearest goal. Every route is at least as long as the great circle between its ends, so that
+ * estimate never overshoots and the first goal to come off the heap ends the shortest route. An airport can be pushed again
+ * when a shorter route to it is found; the stale entries are skipped when they come off the heap. Blocked airports
+ * and routes are never entered.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param workspace The workspace, with a search begun and its goals set.
+ * @param starts The ids of the airports the route may start at.
+ * @param goalDirected True to order the search by distance so far plus distance to the nearest goal (A*), false
+ * to order it by distance so far only (Dijkstra).
+ * @return The shortest route that avoids the blocked airports and routes, or an empty result if no goal can be reached.
+ */
+SearchResult RouteSearch::bestFirst(const FlightGraph &graph, SearchWorkspace &workspace, const std::vector<std::uint32_t> &starts, bool goalDirected)
+{
+    SearchResult result;
+    if (workspace.Targets.empty())
+    {
+        return result;
+    }
+
+    // heap entries are (estimated total distance, airport); Remaining caches each airport's estimate to the goals
+    typedef std::pair<double, std::uint32_t> HeapEntry;
+    std::uint32_t generation = workspace.Generation;
+    std::vector<HeapEntry> &heap = workspace.Heap;
+    auto estimate = [&](std::uint32_t id)
+    {
+        if (!goalDirected)
+        {
+            return 0.0;
+        }
+        if (workspace.Estimated[id] != workspace.GoalGeneration)
+        {
+            workspace.Estimated[id] = workspace.GoalGeneration;
+            workspace.Remaining[id] = std::numeric_limits<double>::infinity();
+            for (auto const &target : workspace.Targets)
+            {
+                workspace.Remaining[id] = std::min(workspace.Remaining[id], graph.distanceBound(id, target));
+            }
+        }
+        return workspace.Remaining[id];
+    };
+    auto distanceOf = [&](std::uint32_t id)
+    {
+        return workspace.Reached[id] == generation ? workspace.Distances[id] : std::numeric_limits<double>::infinity();
+    };
+    auto push = [&](double key, std::uint32_t id)
+    {
+        heap.emplace_back(key, id);
+        std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+    };
+    for (auto const &start : starts)
+    {
+        if (start < graph.airportCount() && workspace.Blocked[start] != generation && workspace.Reached[start] != generation)
+        {
+            workspace.Reached[start] = generation;
+            workspace.Distances[start] = 0;
+            workspace.Parents[start] = start;
+            push(estimate(start), start);
+        }
+    }
+
+    const std::uint32_t *neighbors = graph.neighbors().data();
+    std::uint32_t reached = IataTable::NoId;
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        HeapEntry top = heap.back();
+        heap.pop_back();
+        std::uint32_t parent = top.second;
+        double travelled = workspace.Distances[parent];
+        if (top.first > travelled + estimate(parent))
+        {
+            continue;
+        }
+        result.Expanded++;
+        if (workspace.IsGoal[parent] == workspace.GoalGeneration)
+        {
+            reached = parent;
+            break;
+        }
+
+        const double *distance = graph.distancesBegin(parent);
+        for (const std::uint32_t *child = graph.successorsBegin(parent); child != graph.successorsEnd(parent); child++, distance++)
+        {
+            if (workspace.Blocked[*child] == generation || workspace.BlockedRoutes[child - neighbors] == generation)
+            {
+                continue;
+            }
+            double candidate = travelled + *distance;
+            if (candidate < distanceOf(*child))
+            {
+                workspace.Reached[*child] = generation;
+                workspace.Distances[*child] = candidate;
+                workspace.Parents[*child] = parent;
+                push(candidate + estimate(*child), *child);
+            }
+        }
+    }
+
+    if (reached == IataTable::NoId)
+    {
+        return result;
+    }
+    // start airports are their own parents
+    std::uint32_t id = reached;
+    result.Path.push_back(id);
+    while (workspace.Parents[id] != id)
+    {
+        id = workspace.Parents[id];
+        result.Path.push_back(id);
+    }
+    std::reverse(result.Path.begin(), result.Path.end());
+    result.Distance = workspace.Distances[reached];
+    return result;
+}
+
+/**
+ * @brief Runs a single best-first search in the workspace of the calling thread.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param starts The ids of the airports the route may start at.
+ * @param goals The ids of the airports the route may end at.
+ * @param goalDirected True for A*, false for Dijkstra's algorithm.
+ * @return The shortest route, or an empty result if no goal can be reached.
+ */
+SearchResult RouteSearch::bestFirst(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals, bool goalDirected)
+{
+    SearchWorkspace &workspace = threadWorkspace(graph);
+    setGoals(graph, workspace, goals);
+    return bestFirst(graph, workspace, starts, goalDirected);
+}
+
+/**
+ * @brief Joins the forward and backward halves of a bidirectional search at the airport where they met.
+ * Start airports are their own forward parents and goal airports their own backward parents.
+ *
+ * @param graph The route graph.
+ * @param workspace The workspace of the search.
+ * @param meeting The id of an airport reached by both halves.
+ * @param result Receives the route; its Expanded count is left as it is.
+ */
+void RouteSearch::joinHalves(const FlightGraph &graph, const SearchWorkspace &workspace, std::uint32_t meeting, SearchResult &result)
+{
+    std::uint32_t id = meeting;
+    result.Path.push_back(id);
+    while (workspace.Parents[id] != id)
+    {
+        id = workspace.Parents[id];
+        result.Path.push_back(id);
+    }
+    std::reverse(result.Path.begin(), result.Path.end());
+    id = meeting;
+    while (workspace.BackwardParents[id] != id)
+    {
+        id = workspace.BackwardParents[id];
+        result.Path.push_back(id);
+    }
+
+    result.Distance = 0;
+    for (std::size_t i = 0; i + 1 < result.Path.size(); i++)
+    {
+        result.Distance += graph.routeDistance(graph.findEdge(result.Path[i], result.Path[i + 1]));
+    }
+}
+
+/**
+ * @brief Finds the route with the smallest total great-circle distance using Dijkstra's algorithm.
+ * The search stops as soon as the goal is settled.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param start The id of the start airport.
+ * @param goal The id of the goal airport.
+ * @return The shortest route, or an empty result if the goal cannot be reached.
+ */
+SearchResult RouteSearch::dijkstra(const FlightGraph &graph, std::uint32_t start, std::uint32_t goal)
+{
+    return bestFirst(graph, std::vector<std::uint32_t>(1, start), std::vector<std::uint32_t>(1, goal), false);
+}
+
+/**
+ * @brief Finds the route with the smallest total great-circle distance using A* search.
+ * The great-circle distance to the goal steers the search towards it, so far fewer airports are expanded than
+ * with Dijkstra's algorithm while the route found is just as short.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param start The id of the start airport.
+ * @param goal The id of the goal airport.
+ * @return The shortest route, or an empty result if the goal cannot be reached.
+ */
+SearchResult RouteSearch::aStar(const FlightGraph &graph, std::uint32_t start, std::uint32_t goal)
+{
+    return bestFirst(graph, std::vector<std::uint32_t>(1, start), std::vector<std::uint32_t>(1, goal), true);
+}
+
+/**
+ * @brief Finds the shortest route from any of several start airports to any of several goal airports using
+ * Dijkstra's algorithm, in a single search.
+ * The search stops at the first goal it settles.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param starts The ids of the airports the route may start at.
+ * @param goals The ids of the airports the route may end at.
+ * @return The shortest route, or an empty result if no goal can be reached.
+ */
+SearchResult RouteSearch::dijkstra(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals)
+{
+    return bestFirst(graph, starts, goals, false);
+}
+
+/**
+ * @brief Finds the shortest route from any of several start airports to any of several goal airports using A*
+ * search, in a single search.
+ * The heuristic is a lower bound on the great-circle distance to the nearest goal, which still never overestimates.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param starts The ids of the airports the route may start at.
+ * @param goals The ids of the airports the route may end at.
+ * @return The shortest route, or an empty result if no goal can be reached.
+ */
+SearchResult RouteSearch::aStar(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals)
+{
+    return bestFirst(graph, starts, goals, true);
+}
+
+/**
+ * @brief Finds the route with the fewest flights from any of several start airports to any of several goal airports,
+ * with a breadth-first search from both ends at once.
+ *
+ * The forward half grows from every start over the routes and the backward half from every goal over the reversed
+ * routes, one whole level at a time, always on the side with the smaller frontier; a hub airport on one side therefore
+ * never floods the search with its hundreds of successors while the other side is still small. Once a level reaches
+ * an airport the other half has reached, the best meeting point of that level ends the route with the fewest flights.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param starts The ids of the airports the route may start at.
+ * @param goals The ids of the airports the route may end at.
+ * @return The route with the fewest flights, or an empty result if no goal can be reached. Its Distance is the
+ * length of the route.
+ */
+SearchResult RouteSearch::fewestHops(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals)
+{
+    SearchResult result;
+    SearchWorkspace &workspace = threadWorkspace(graph);
+    std::uint32_t generation = workspace.Generation;
+
+    // hop counts are kept in the distance arrays; heads mark the first airport of each half's current level
+    std::vector<std::uint32_t> *queues[2] = {&workspace.Queue, &workspace.BackwardQueue};
+    std::vector<double> *hops[2] = {&workspace.Distances, &workspace.BackwardDistances};
+    std::vector<std::uint32_t> *parents[2] = {&workspace.Parents, &workspace.BackwardParents};
+    std::vector<std::uint32_t> *reached[2] = {&workspace.Reached, &workspace.BackwardReached};
+    const std::vector<std::uint32_t> *ends[2] = {&starts, &goals};
+    std::size_t heads[2] = {0, 0};
+    std::uint32_t meeting = IataTable::NoId;
+    double best = std::numeric_limits<double>::infinity();
+    for (int direction = 0; direction < 2; direction++)
+    {
+        for (auto const &end : *ends[direction])
+        {
+            if (end < graph.airportCount() && (*reached[direction])[end] != generation)
+            {
+                (*reached[direction])[end] = generation;
+                (*hops[direction])[end] = 0;
+                (*parents[direction])[end] = end;
+                queues[direction]->push_back(end);
+                if (direction == 1 && workspace.Reached[end] == generation)
+                {
+                    best = 0;
+                    meeting = end;
+                }
+            }
+        }
+    }
+
+    while (meeting == IataTable::NoId && heads[0] < queues[0]->size() && heads[1] < queues[1]->size())
+    {
+        int direction = queues[0]->size() - heads[0] <= queues[1]->size() - heads[1] ? 0 : 1;
+        std::vector<std::uint32_t> &queue = *queues[direction];
+        std::vector<double> &otherHops = *hops[1 - direction];
+        const std::vector<std::uint32_t> &otherReached = *reached[1 - direction];
+        std::size_t levelEnd = queue.size();
+        for (; heads[direction] < levelEnd; heads[direction]++)
+        {
+            std::uint32_t parent = queue[heads[direction]];
+            result.Expanded++;
+            const std::uint32_t *begin = direction == 0 ? graph.successorsBegin(parent) : graph.predecessorsBegin(parent);
+            const std::uint32_t *end = direction == 0 ? graph.successorsEnd(parent) : graph.predecessorsEnd(parent);
+            for (const std::uint32_t *child = begin; child != end; child++)
+            {
+                if ((*reached[direction])[*child] == generation)
+                {
+                    continue;
+                }
+                (*reached[direction])[*child] = generation;
+                (*hops[direction])[*child] = (*hops[direction])[parent] + 1;
+                (*parents[direction])[*child] = parent;
+                queue.push_back(*child);
+                if (otherReached[*child] == generation && (*hops[direction])[*child] + otherHops[*child] < best)
+                {
+                    best = (*hops[direction])[*child] + otherHops[*child];
+                    meeting = *child;
+                }
+            }
+        }
+    }
+
+    if (meeting != IataTable::NoId)
+    {
+        joinHalves(graph, workspace, meeting, result);
+    }
+    return result;
+}
+
+/**
+ * @brief Finds the route with the smallest total great-circle distance from any of several start airports to any
+ * of several goal airports, with Dijkstra searches from both ends at once.
+ *
+ * The forward half settles airports outwards from the starts over the routes, the backward half inwards to the goals
+ * over the reversed routes, and each step expands whichever half has the nearer airport on its heap. Every route
+ * between an airport reached forwards and one reached backwards is a candidate; the search stops once the nearest
+ * airports left on both heaps together are no closer than the best candidate, since no route through an unsettled
+ * airport can then be shorter.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param starts The ids of the airports the route may start at.
+ * @param goals The ids of the airports the route may end at.
+ * @return The shortest route, or an empty result if no goal can be reached.
+ */
+SearchResult RouteSearch::bidirectional(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    SearchResult result;
+    SearchWorkspace &workspace = threadWorkspace(graph);
+    std::uint32_t generation = workspace.Generation;
+
+    typedef std::pair<double, std::uint32_t> HeapEntry;
+    std::vector<HeapEntry> *heaps[2] = {&workspace.Heap, &workspace.BackwardHeap};
+    std::vector<double> *distances[2] = {&workspace.Distances, &workspace.BackwardDistances};
+    std::vector<std::uint32_t> *parents[2] = {&workspace.Parents, &workspace.BackwardParents};
+    std::vector<std::uint32_t> *reached[2] = {&workspace.Reached, &workspace.BackwardReached};
+    const std::vector<std::uint32_t> *ends[2] = {&starts, &goals};
+    auto distanceOf = [&](int direction, std::uint32_t id)
+    {
+        return (*reached[direction])[id] == generation ? (*distances[direction])[id] : infinity;
+    };
+    for (int direction = 0; direction < 2; direction++)
+    {
+        for (auto const &end : *ends[direction])
+        {
+            if (end < graph.airportCount() && (*reached[direction])[end] != generation)
+            {
+                (*reached[direction])[end] = generation;
+                (*distances[direction])[end] = 0;
+                (*parents[direction])[end] = end;
+                heaps[direction]->emplace_back(0, end);
+            }
+        }
+    }
+
+    double best = infinity;
+    std::uint32_t meeting = IataTable::NoId;
+    while (!heaps[0]->empty() && !heaps[1]->empty() && heaps[0]->front().first + heaps[1]->front().first < best)
+    {
+        int direction = heaps[0]->front().first <= heaps[1]->front().first ? 0 : 1;
+        std::vector<HeapEntry> &heap = *heaps[direction];
+        std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        HeapEntry top = heap.back();
+        heap.pop_back();
+        std::uint32_t parent = top.second;
+        if (top.first > (*distances[direction])[parent])
+        {
+            continue;
+        }
+        result.Expanded++;
+        if (top.first + distanceOf(1 - direction, parent) < best)
+        {
+            best = top.first + distanceOf(1 - direction, parent);
+            meeting = parent;
+        }
+
+        const std::uint32_t *begin = direction == 0 ? graph.successorsBegin(parent) : graph.predecessorsBegin(parent);
+        const std::uint32_t *end = direction == 0 ? graph.successorsEnd(parent) : graph.predecessorsEnd(parent);
+        const double *distance = direction == 0 ? graph.distancesBegin(parent) : graph.reverseDistancesBegin(parent);
+        for (const std::uint32_t *child = begin; child != end; child++, distance++)
+        {
+            double candidate = top.first + *distance;
+            if (candidate < distanceOf(direction, *child))
+            {
+                (*reached[direction])[*child] = generation;
+                (*distances[direction])[*child] = candidate;
+                (*parents[direction])[*child] = parent;
+                heap.emplace_back(candidate, *child);
+                std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+                if (candidate + distanceOf(1 - direction, *child) < best)
+                {
+                    best = candidate + distanceOf(1 - direction, *child);
+                    meeting = *child;
+                }
+            }
+        }
+    }
+
+    if (meeting != IataTable::NoId)
+    {
+        joinHalves(graph, workspace, meeting, result);
+    }
+    return result;
+}
+
+/**
+ * @brief Finds the k shortest loopless routes from any of several start airports to any of several goal airports
+ * with Yen's algorithm.
+ *
+ * Every route found after the first leaves an earlier route at some airport, its spur. For each airport of the last
+ * route found, a spur search runs from it with the airports before it blocked, and with the next route of every
+ * earlier route that shares the same beginning blocked, so each spur search finds a new route. The candidates wait
+ * in an ordered set and the shortest becomes the next route. Choosing a different start airport counts as leaving at
+ * the very beginning: the start airports already used are dropped from a multi-source search. All spur searches
+ * share one workspace and one set of cached distance estimates, since the goals never change.
+ *
+ * @param graph The route graph, with its routes measured.
+ * @param starts The ids of the airports the routes may start at.
+ * @param goals The ids of the airports the routes may end at.
+ * @param k The number of routes to find.
+ * @return Up to k distinct routes, shortest first; routes of equal length are ordered by their airport ids. The
+ * Expanded count of every route after the first covers all the spur searches run to find it.
+ */
+std::vector<SearchResult> RouteSearch::kShortest(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals, std::size_t k)
+{
+    std::vector<SearchResult> routes;
+    if (k == 0)
+    {
+        return routes;
+    }
+    SearchWorkspace &workspace = threadWorkspace(graph);
+    setGoals(graph, workspace, goals);
+    SearchResult first = bestFirst(graph, workspace, starts, true);
+    if (!first.found())
+    {
+        return routes;
+    }
+    routes.push_back(first);
+
+    // candidates are ordered by length, then by path, so ties are broken the same way on every run
+    std::set<std::pair<double, std::vector<std::uint32_t>>> candidates;
+    std::set<std::vector<std::uint32_t>> seen;
+    seen.insert(first.Path);
+    auto addCandidate = [&](std::vector<std::uint32_t> path, double distance)
+    {
+        if (seen.insert(path).second)
+        {
+            candidates.emplace(distance, std::move(path));
+        }
+    };
+
+    std::vector<std::uint32_t> spurStart(1);
+    while (routes.size() < k)
+    {
+        const std::vector<std::uint32_t> previous = routes.back().Path;
+        std::size_t expanded = 0;
+
+        // leaving at the very beginning: start from an airport no route found so far starts at
+        std::vector<std::uint32_t> unusedStarts;
+        for (auto const &start : starts)
+        {
+            bool used = false;
+            for (auto const &route : routes)
+            {
+                used = used || route.Path.front() == start;
+            }
+            if (!used)
+            {
+                unusedStarts.push_back(start);
+            }
+        }
+        beginSearch(graph, workspace);
+        SearchResult spur = bestFirst(graph, workspace, unusedStarts, true);
+        expanded += spur.Expanded;
+        if (spur.found())
+        {
+            addCandidate(spur.Path, spur.Distance);
+        }
+
+        // leaving at every airport of the last route but the goal
+        double rootDistance = 0;
+        for (std::size_t i = 0; i + 1 < previous.size(); i++)
+        {
+            beginSearch(graph, workspace);
+            for (std::size_t j = 0; j < i; j++)
+            {
+                workspace.Blocked[previous[j]] = workspace.Generation;
+            }
+            for (auto const &route : routes)
+            {
+                if (route.Path.size() > i + 1 && std::equal(previous.begin(), previous.begin() + i + 1, route.Path.begin()))
+                {
+                    workspace.BlockedRoutes[graph.findEdge(route.Path[i], route.Path[i + 1])] = workspace.Generation;
+                }
+            }
+            spurStart[0] = previous[i];
+            spur = bestFirst(graph, workspace, spurStart, true);
+            expanded += spur.Expanded;
+            if (spur.found())
+            {
+                std::vector<std::uint32_t> path(previous.begin(), previous.begin() + i);
+                path.insert(path.end(), spur.Path.begin(), spur.Path.end());
+                addCandidate(std::move(path), rootDistance + spur.Distance);
+            }
+            rootDistance += graph.routeDistance(graph.findEdge(previous[i], previous[i + 1]));
+        }
+
+        if (candidates.empty())
+        {
+            break;
+        }
+        SearchResult next;
+        next.Distance = candidates.begin()->first;
+        next.Path = candidates.begin()->second;
+        next.Expanded = expanded;
+        candidates.erase(candidates.begin());
+        routes.push_back(next);
+    }
+    return routes;
+}
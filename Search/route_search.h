@@ -0,0 +1,226 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef ROUTE_SEARCH_H
+#define ROUTE_SEARCH_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include "../Graph/flight_graph.h"
+
+/**
+ * @brief The algorithms a route search can run with.
+ */
+enum class SearchMode
+{
+    Dijkstra, /**< Uninformed search, expanding airports in order of distance from the start. */
+    AStar, /**< Goal-directed search, guided by the great-circle distance to the goal. */
+    Bidirectional, /**< Uninformed search from both ends at once, forwards from the start and backwards from the goal. */
+    Hierarchy /**< Bidirectional upward search over the contraction hierarchy of the route graph. */
+};
+
+/**
+ * @struct SearchResult
+ * @brief The route found by a search over the route graph.
+ */
+struct SearchResult
+{
+    std::vector<std::uint32_t> Path; /**< The ids of the airports on the route, start first; empty if there is no route. */
+    double Distance = 0; /**< The great-circle length of the route in kilometers. */
+    std::size_t Expanded = 0; /**< The number of airports the search expanded. */
+
+    /**
+     * @brief Checks whether the search found a route.
+     *
+     * @return True if a route was found, false otherwise.
+     */
+    bool found() const { return !Path.empty(); }
+};
+
+/**
+ * @struct SearchWorkspace
+ * @brief The per-airport and per-route arrays of a search, kept between searches so they are allocated once.
+ *
+ * Every thread has its own workspace, so searches on different threads never share state. Entries are stamped
+ * with the generation of the search that wrote them instead of being cleared, so starting a new search over the
+ * same arrays costs the same however large the graph is. Airports and routes can be blocked for a single search
+ * by stamping them with its generation, which is how the spur searches of kShortest leave out the parts of the
+ * routes already found. Bidirectional searches keep the state of their backward half in the Backward arrays,
+ * stamped with the same generation.
+ */
+struct SearchWorkspace
+{
+    std::vector<double> Distances; /**< The tentative distance of every airport reached by the current search. */
+    std::vector<std::uint32_t> Parents; /**< The airport every airport was reached from by the current search. */
+    std::vector<std::uint32_t> Reached; /**< The generation of the search that last set an airport's distance. */
+    std::vector<std::uint32_t> Blocked; /**< The generation of the search an airport is blocked for. */
+    std::vector<std::uint32_t> BlockedRoutes; /**< The generation of the search a route is blocked for, by route index. */
+    std::vector<double> Remaining; /**< The cached estimate of every airport's distance to the nearest goal. */
+    std::vector<std::uint32_t> Estimated; /**< The goal generation an airport's estimate was made for. */
+    std::vector<std::uint32_t> IsGoal; /**< The goal generation an airport is a goal of. */
+    std::vector<std::uint32_t> Targets; /**< The goals of the current goal generation. */
+    std::vector<std::pair<double, std::uint32_t>> Heap; /**< The binary heap of the current search. */
+    std::vector<double> BackwardDistances; /**< The tentative distance of every airport to the goals, for the backward half. */
+    std::vector<std::uint32_t> BackwardParents; /**< The airport every airport was reached from by the backward half. */
+    std::vector<std::uint32_t> BackwardReached; /**< The generation of the search that last set an airport's backward distance. */
+    std::vector<std::pair<double, std::uint32_t>> BackwardHeap; /**< The binary heap of the backward half. */
+    std::vector<std::uint32_t> Queue; /**< The airports reached by a breadth-first search, in the order they were reached. */
+    std::vector<std::uint32_t> BackwardQueue; /**< The airports reached by the backward half of a breadth-first search. */
+    std::uint32_t Generation = 0; /**< The generation of the current search. */
+    std::uint32_t GoalGeneration = 0; /**< The generation of the current set of goals. */
+};
+
+/**
+ * @class RouteSearch
+ * @brief Shortest route searches over the route graph.
+ *
+ * Searches work on airport ids and the route lengths measured by FlightGraph::weighRoutes; they do not touch the
+ * global airport or route maps, so they can run on any graph. Each thread searches in its own SearchWorkspace, so
+ * searches on different threads can run at once, and a search allocates nothing but its result.
+ */
+class RouteSearch
+{
+
+private:
+    /**
+     * @brief Sizes a workspace for a graph and starts a new search generation, unblocking every airport and route.
+     *
+     * @param graph The route graph the next search runs on.
+     * @param workspace The workspace to prepare.
+     */
+    static void beginSearch(const FlightGraph &graph, SearchWorkspace &workspace);
+
+    /**
+     * @brief Gets the workspace of the calling thread, with a new search begun on a graph.
+     *
+     * @param graph The route graph the next search runs on.
+     * @return The workspace of the calling thread.
+     */
+    static SearchWorkspace &threadWorkspace(const FlightGraph &graph);
+
+    /**
+     * @brief Sets the goals of the following searches, dropping the distance estimates made for earlier goals.
+     * Ids that are not in the graph (such as IataTable::NoId for unknown airports) are ignored.
+     *
+     * @param graph The route graph, after beginSearch has sized the workspace for it.
+     * @param workspace The workspace of the searches.
+     * @param goals The ids of the airports the routes may end at.
+     */
+    static void setGoals(const FlightGraph &graph, SearchWorkspace &workspace, const std::vector<std::uint32_t> &goals);
+
+    /**
+     * @brief Runs a best-first search for the shortest route from any start airport to any goal airport, with or
+     * without the great-circle heuristic.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param workspace The workspace, with a search begun and its goals set.
+     * @param starts The ids of the airports the route may start at.
+     * @param goalDirected True to order the search by distance so far plus distance to the nearest goal (A*), false
+     * to order it by distance so far only (Dijkstra).
+     * @return The shortest route that avoids the blocked airports and routes, or an empty result if no goal can be reached.
+     */
+    static SearchResult bestFirst(const FlightGraph &graph, SearchWorkspace &workspace, const std::vector<std::uint32_t> &starts, bool goalDirected);
+
+    /**
+     * @brief Runs a single best-first search in the workspace of the calling thread.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param starts The ids of the airports the route may start at.
+     * @param goals The ids of the airports the route may end at.
+     * @param goalDirected True for A*, false for Dijkstra's algorithm.
+     * @return The shortest route, or an empty result if no goal can be reached.
+     */
+    static SearchResult bestFirst(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals, bool goalDirected);
+
+    /**
+     * @brief Joins the forward and backward halves of a bidirectional search at the airport where they met.
+     *
+     * @param graph The route graph.
+     * @param workspace The workspace of the search.
+     * @param meeting The id of an airport reached by both halves.
+     * @param result Receives the route; its Expanded count is left as it is.
+     */
+    static void joinHalves(const FlightGraph &graph, const SearchWorkspace &workspace, std::uint32_t meeting, SearchResult &result);
+
+public:
+    /**
+     * @brief Finds the route with the smallest total great-circle distance using Dijkstra's algorithm.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param start The id of the start airport.
+     * @param goal The id of the goal airport.
+     * @return The shortest route, or an empty result if the goal cannot be reached.
+     */
+    static SearchResult dijkstra(const FlightGraph &graph, std::uint32_t start, std::uint32_t goal);
+
+    /**
+     * @brief Finds the route with the smallest total great-circle distance using A* search.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param start The id of the start airport.
+     * @param goal The id of the goal airport.
+     * @return The shortest route, or an empty result if the goal cannot be reached.
+     */
+    static SearchResult aStar(const FlightGraph &graph, std::uint32_t start, std::uint32_t goal);
+
+    /**
+     * @brief Finds the shortest route from any of several start airports to any of several goal airports using
+     * Dijkstra's algorithm, in a single search.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param starts The ids of the airports the route may start at.
+     * @param goals The ids of the airports the route may end at.
+     * @return The shortest route, or an empty result if no goal can be reached.
+     */
+    static SearchResult dijkstra(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals);
+
+    /**
+     * @brief Finds the shortest route from any of several start airports to any of several goal airports using A*
+     * search, in a single search.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param starts The ids of the airports the route may start at.
+     * @param goals The ids of the airports the route may end at.
+     * @return The shortest route, or an empty result if no goal can be reached.
+     */
+    static SearchResult aStar(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals);
+
+    /**
+     * @brief Finds the route with the fewest flights from any of several start airports to any of several goal airports,
+     * with a breadth-first search from both ends at once.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param starts The ids of the airports the route may start at.
+     * @param goals The ids of the airports the route may end at.
+     * @return The route with the fewest flights, or an empty result if no goal can be reached. Its Distance is the
+     * length of the route.
+     */
+    static SearchResult fewestHops(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals);
+
+    /**
+     * @brief Finds the route with the smallest total great-circle distance from any of several start airports to any
+     * of several goal airports, with Dijkstra searches from both ends at once.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param starts The ids of the airports the route may start at.
+     * @param goals The ids of the airports the route may end at.
+     * @return The shortest route, or an empty result if no goal can be reached.
+     */
+    static SearchResult bidirectional(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals);
+
+    /**
+     * @brief Finds the k shortest loopless routes from any of several start airports to any of several goal airports
+     * with Yen's algorithm.
+     *
+     * @param graph The route graph, with its routes measured.
+     * @param starts The ids of the airports the routes may start at.
+     * @param goals The ids of the airports the routes may end at.
+     * @param k The number of routes to find.
+     * @return Up to k distinct routes, shortest first; routes of equal length are ordered by their airport ids. The
+     * Expanded count of every route after the first covers all the spur searches run to find it.
+     */
+    static std::vector<SearchResult> kShortest(const FlightGraph &graph, const std::vector<std::uint32_t> &starts, const std::vector<std::uint32_t> &goals, std::size_t k);
+};
+
+#endif // ROUTE_SEARCH_H
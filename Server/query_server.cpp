@@ -0,0 +1,744 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define QUERY_SERVER_EPOLL
+#else
+#include <poll.h>
+#endif
+#include "query_server.h"
+#include "../Plan/flight_plan.h"
+#include "../Network/network.h"
+#include "../ReadWrite/read_write.h"
+
+/**
+ * @brief The event flag of a descriptor with data to read, or of a listening socket with a connection waiting.
+ */
+static const std::uint32_t Readable = 1;
+
+/**
+ * @brief The event flag of a descriptor that can take more data.
+ */
+static const std::uint32_t Writable = 2;
+
+/**
+ * @brief The most replies a connection may owe before the server stops reading its queries, so one client cannot
+ * queue unbounded work.
+ */
+static const std::size_t MaxPendingReplies = 256;
+
+/**
+ * @brief The longest query line accepted; a connection sending a longer line is dropped.
+ */
+static const std::size_t MaxLineLength = 4096;
+
+/**
+ * @brief How long in milliseconds the event loop sleeps at most while a reload or update request waits for the
+ * running one to finish.
+ */
+static const int RequestRetryInterval = 100;
+
+/**
+ * @brief Set by the signal handler when the server should stop.
+ */
+static volatile std::sig_atomic_t StopRequested = 0;
+
+/**
+ * @brief Set by the signal handler when the network should be reloaded from its data files.
+ */
+static volatile std::sig_atomic_t ReloadRequested = 0;
+
+/**
+ * @brief Set by the signal handler when the route delta file should be applied to the network.
+ */
+static volatile std::sig_atomic_t DeltaRequested = 0;
+
+/**
+ * @brief The write end of the wake pipe of the running server, for the signal handler.
+ */
+static int SignalWakeFd = -1;
+
+/**
+ * @brief Asks the running server to stop, from a signal handler.
+ */
+static void requestStop(int)
+{
+    StopRequested = 1;
+    if (SignalWakeFd >= 0)
+    {
+        char byte = 0;
+        ssize_t ignored = write(SignalWakeFd, &byte, 1);
+        (void)ignored;
+    }
+}
+
+/**
+ * @brief Asks the running server to reload the network, from a signal handler.
+ */
+static void requestReload(int)
+{
+    ReloadRequested = 1;
+    if (SignalWakeFd >= 0)
+    {
+        char byte = 0;
+        ssize_t ignored = write(SignalWakeFd, &byte, 1);
+        (void)ignored;
+    }
+}
+
+/**
+ * @brief Asks the running server to apply its route delta file, from a signal handler.
+ */
+static void requestDelta(int)
+{
+    DeltaRequested = 1;
+    if (SignalWakeFd >= 0)
+    {
+        char byte = 0;
+        ssize_t ignored = write(SignalWakeFd, &byte, 1);
+        (void)ignored;
+    }
+}
+
+/**
+ * @brief Makes a descriptor non-blocking.
+ *
+ * @param fd The descriptor.
+ * @return True if the descriptor is now non-blocking, false otherwise.
+ */
+static bool setNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/**
+ * @brief Removes the spaces around a string.
+ *
+ * @param text The string.
+ * @return The string without leading and trailing spaces.
+ */
+static std::string trimmed(const std::string &text)
+{
+    std::size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos)
+    {
+        return "";
+    }
+    std::size_t end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Splits a "city, country" place into its city and country.
+ *
+ * @param place The place.
+ * @param city Receives the city.
+ * @param country Receives the country.
+ * @return True if the place names a city and a country, false otherwise.
+ */
+static bool splitPlace(const std::string &place, std::string &city, std::string &country)
+{
+    std::size_t comma = place.find(',');
+    if (comma == std::string::npos)
+    {
+        return false;
+    }
+    city = trimmed(place.substr(0, comma));
+    country = trimmed(place.substr(comma + 1));
+    return !city.empty() && !country.empty();
+}
+
+/**
+ * @brief Creates the wake pipe, the poller and the thread pool.
+ *
+ * @param threads The number of worker threads, or 0 to use every hardware thread.
+ */
+QueryServer::QueryServer(unsigned threads) : Workers(threads)
+{
+    this->WakePipe[0] = -1;
+    this->WakePipe[1] = -1;
+    this->ListenFd = -1;
+    this->Poller = -1;
+    this->DroppedConnection = false;
+#ifdef QUERY_SERVER_EPOLL
+    this->Poller = epoll_create1(EPOLL_CLOEXEC);
+#endif
+    if (pipe(this->WakePipe) == 0)
+    {
+        setNonBlocking(this->WakePipe[0]);
+        setNonBlocking(this->WakePipe[1]);
+        watch(this->WakePipe[0], Readable);
+    }
+}
+
+/**
+ * @brief Waits for the queued queries, then closes every connection, the wake pipe and the poller.
+ * No worker can touch the reply mutex or the wake pipe once the wait returns.
+ */
+QueryServer::~QueryServer()
+{
+    Workers.wait();
+    for (auto &entry : Connections)
+    {
+        closeConnection(*entry.second);
+    }
+    Connections.clear();
+    if (ListenFd >= 0)
+    {
+        close(ListenFd);
+    }
+    if (Poller >= 0)
+    {
+        close(Poller);
+    }
+    for (int fd : WakePipe)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+/**
+ * @brief Watches a descriptor for the given events, or stops watching it if there are none.
+ *
+ * @param fd The descriptor.
+ * @param events The events to watch, as a mask of the Readable and Writable flags.
+ * @return True if the descriptor is watched as asked, false if it cannot be watched (such as a regular file).
+ */
+bool QueryServer::watch(int fd, std::uint32_t events)
+{
+    auto found = Interests.find(fd);
+    std::uint32_t current = found == Interests.end() ? 0 : found->second;
+    if (events == current)
+    {
+        return true;
+    }
+#ifdef QUERY_SERVER_EPOLL
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.data.fd = fd;
+    event.events = ((events & Readable) ? static_cast<std::uint32_t>(EPOLLIN) : 0u) | ((events & Writable) ? static_cast<std::uint32_t>(EPOLLOUT) : 0u);
+    int operation = events == 0 ? EPOLL_CTL_DEL : (current == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD);
+    if (epoll_ctl(Poller, operation, fd, &event) != 0)
+    {
+        return false;
+    }
+#else
+    // poll cannot tell a regular file apart either, so rule those out the same way epoll does
+    struct stat status;
+    if (events != 0 && fstat(fd, &status) == 0 && S_ISREG(status.st_mode))
+    {
+        return false;
+    }
+#endif
+    if (events == 0)
+    {
+        Interests.erase(fd);
+    }
+    else
+    {
+        Interests[fd] = events;
+    }
+    return true;
+}
+
+/**
+ * @brief Waits until a watched descriptor is ready.
+ * Errors and hang-ups are reported as readable and writable, so the next read or write sees them.
+ *
+ * @param timeout The longest time to wait in milliseconds, or -1 to wait for ever.
+ * @param ready Receives every ready descriptor and its ready events.
+ */
+void QueryServer::wait(int timeout, std::vector<std::pair<int, std::uint32_t>> &ready)
+{
+    ready.clear();
+#ifdef QUERY_SERVER_EPOLL
+    epoll_event events[64];
+    int count = epoll_wait(Poller, events, 64, timeout);
+    for (int i = 0; i < count; i++)
+    {
+        std::uint32_t flags = 0;
+        flags |= (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) ? Readable : 0;
+        flags |= (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) ? Writable : 0;
+        int fd = events[i].data.fd;
+        ready.emplace_back(fd, flags);
+    }
+#else
+    std::vector<pollfd> descriptors;
+    descriptors.reserve(Interests.size());
+    for (auto const &entry : Interests)
+    {
+        pollfd descriptor;
+        descriptor.fd = entry.first;
+        descriptor.events = ((entry.second & Readable) ? POLLIN : 0) | ((entry.second & Writable) ? POLLOUT : 0);
+        descriptor.revents = 0;
+        descriptors.push_back(descriptor);
+    }
+    if (poll(descriptors.data(), descriptors.size(), timeout) <= 0)
+    {
+        return;
+    }
+    for (auto const &descriptor : descriptors)
+    {
+        std::uint32_t flags = 0;
+        flags |= (descriptor.revents & (POLLIN | POLLERR | POLLHUP)) ? Readable : 0;
+        flags |= (descriptor.revents & (POLLOUT | POLLERR | POLLHUP)) ? Writable : 0;
+        if (flags != 0)
+        {
+            ready.emplace_back(descriptor.fd, flags);
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Starts serving a connection.
+ *
+ * @param inputFd The descriptor queries are read from; must be non-blocking unless it is a regular file.
+ * @param outputFd The descriptor replies are written to; must be non-blocking unless it is a regular file.
+ */
+void QueryServer::addConnection(int inputFd, int outputFd)
+{
+    std::unique_ptr<Connection> connection(new Connection());
+    connection->InputFd = inputFd;
+    connection->OutputFd = outputFd;
+    Owners[inputFd] = inputFd;
+    Owners[outputFd] = inputFd;
+    Connection &added = *connection;
+    Connections[inputFd] = std::move(connection);
+    updateInterest(added);
+}
+
+/**
+ * @brief Accepts every connection waiting on the listening socket.
+ */
+void QueryServer::acceptConnections()
+{
+    while (true)
+    {
+        int fd = accept(ListenFd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            return;
+        }
+        if (!setNonBlocking(fd))
+        {
+            close(fd);
+            continue;
+        }
+        addConnection(fd, fd);
+    }
+}
+
+/**
+ * @brief Reads what a connection has sent and queues a worker task for every whole query line.
+ * Reading stops while the connection owes MaxPendingReplies replies and resumes as they are written.
+ *
+ * @param connection The connection.
+ */
+void QueryServer::readQueries(Connection &connection)
+{
+    char buffer[4096];
+    while (!connection.InputEnded && !connection.Failed && connection.Replies.size() < MaxPendingReplies)
+    {
+        ssize_t count = read(connection.InputFd, buffer, sizeof(buffer));
+        if (count == 0)
+        {
+            connection.InputEnded = true;
+            break;
+        }
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            connection.Failed = errno != EAGAIN && errno != EWOULDBLOCK;
+            break;
+        }
+        connection.Input.append(buffer, static_cast<std::size_t>(count));
+
+        // every whole line is a query; each gets its reply slot now, so replies go out in query order
+        std::size_t begin = 0;
+        std::size_t end;
+        while ((end = connection.Input.find('\n', begin)) != std::string::npos)
+        {
+            std::string line = connection.Input.substr(begin, end - begin);
+            begin = end + 1;
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            if (trimmed(line).empty())
+            {
+                continue;
+            }
+            std::shared_ptr<Reply> reply = std::make_shared<Reply>();
+            connection.Replies.push_back(reply);
+            int wakeFd = WakePipe[1];
+            Workers.submit([this, reply, line, wakeFd]()
+                           {
+                               std::string text = answer(line);
+                               {
+                                   std::lock_guard<std::mutex> lock(ReplyMutex);
+                                   reply->Text = std::move(text);
+                                   reply->Ready = true;
+                               }
+                               char byte = 0;
+                               ssize_t ignored = write(wakeFd, &byte, 1);
+                               (void)ignored; });
+        }
+        connection.Input.erase(0, begin);
+        if (connection.Input.size() > MaxLineLength)
+        {
+            connection.Failed = true;
+        }
+        if (!connection.Pollable)
+        {
+            // a regular file is always readable; take one buffer per loop turn so replies keep flowing
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Moves the finished replies at the front of a connection's queue to its output and writes as much as
+ * the descriptor takes.
+ *
+ * @param connection The connection.
+ */
+void QueryServer::writeReplies(Connection &connection)
+{
+    {
+        std::lock_guard<std::mutex> lock(ReplyMutex);
+        while (!connection.Replies.empty() && connection.Replies.front()->Ready)
+        {
+            connection.Output += connection.Replies.front()->Text;
+            connection.Output += '\n';
+            connection.Replies.pop_front();
+        }
+    }
+
+    while (connection.OutputSent < connection.Output.size() && !connection.Failed)
+    {
+        ssize_t count;
+        if (connection.OutputFd == connection.InputFd)
+        {
+#ifdef MSG_NOSIGNAL
+            count = send(connection.OutputFd, connection.Output.data() + connection.OutputSent, connection.Output.size() - connection.OutputSent, MSG_NOSIGNAL);
+#else
+            count = send(connection.OutputFd, connection.Output.data() + connection.OutputSent, connection.Output.size() - connection.OutputSent, 0);
+#endif
+        }
+        else
+        {
+            count = write(connection.OutputFd, connection.Output.data() + connection.OutputSent, connection.Output.size() - connection.OutputSent);
+        }
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            connection.Failed = errno != EAGAIN && errno != EWOULDBLOCK;
+            break;
+        }
+        connection.OutputSent += static_cast<std::size_t>(count);
+    }
+    if (connection.OutputSent == connection.Output.size())
+    {
+        connection.Output.clear();
+        connection.OutputSent = 0;
+    }
+}
+
+/**
+ * @brief Updates the events watched for a connection from its state.
+ * Queries are read while the client may send more and the connection owes fewer than MaxPendingReplies replies;
+ * writability is only watched while output is waiting.
+ *
+ * @param connection The connection.
+ */
+void QueryServer::updateInterest(Connection &connection)
+{
+    bool reading = !connection.InputEnded && !connection.Failed && connection.Replies.size() < MaxPendingReplies;
+    bool writing = !connection.Failed && connection.OutputSent < connection.Output.size();
+    if (connection.InputFd == connection.OutputFd)
+    {
+        watch(connection.InputFd, (reading ? Readable : 0) | (writing ? Writable : 0));
+        return;
+    }
+    if (connection.Pollable && !watch(connection.InputFd, reading ? Readable : 0))
+    {
+        connection.Pollable = false;
+    }
+    watch(connection.OutputFd, writing ? Writable : 0);
+}
+
+/**
+ * @brief Stops watching a connection and closes its descriptors.
+ * Standard input and output are left open.
+ *
+ * @param connection The connection.
+ */
+void QueryServer::closeConnection(Connection &connection)
+{
+    watch(connection.InputFd, 0);
+    watch(connection.OutputFd, 0);
+    Owners.erase(connection.InputFd);
+    Owners.erase(connection.OutputFd);
+    if (connection.InputFd > STDERR_FILENO)
+    {
+        close(connection.InputFd);
+    }
+    if (connection.OutputFd != connection.InputFd && connection.OutputFd > STDERR_FILENO)
+    {
+        close(connection.OutputFd);
+    }
+}
+
+/**
+ * @brief Runs the event loop until a stop is requested, or, when serving standard input, until every query has
+ * been answered.
+ *
+ * Every turn waits for the watched descriptors, drains the wake pipe, accepts and reads what is ready, then writes
+ * the replies workers have finished and drops the connections that are done.
+ */
+void QueryServer::run()
+{
+    std::vector<std::pair<int, std::uint32_t>> ready;
+    while (!StopRequested)
+    {
+        if (ListenFd < 0 && Connections.empty())
+        {
+            return;
+        }
+        // a connection reading a regular file is never reported ready, so do not sleep while it has input left
+        bool busy = false;
+        for (auto const &entry : Connections)
+        {
+            busy = busy || (!entry.second->Pollable && !entry.second->InputEnded && entry.second->Replies.size() < MaxPendingReplies);
+        }
+        // a request made while a reload or update runs is kept until that one finishes, so the loop wakes to retry it
+        bool waiting = (ReloadRequested || DeltaRequested) && Network::reloadRunning();
+        wait(busy ? 0 : waiting ? RequestRetryInterval : -1, ready);
+        if (ReloadRequested && !Network::reloadRunning())
+        {
+            ReloadRequested = 0;
+            Network::reloadInBackground();
+        }
+        if (DeltaRequested && !Network::reloadRunning())
+        {
+            DeltaRequested = 0;
+            if (DeltaFilename.empty())
+            {
+                std::cout << "error applying route delta: the server was started without a delta file" << std::endl;
+            }
+            else
+            {
+                Network::applyDeltaInBackground(DeltaFilename);
+            }
+        }
+
+        for (auto const &event : ready)
+        {
+            if (event.first == WakePipe[0])
+            {
+                char buffer[256];
+                while (read(WakePipe[0], buffer, sizeof(buffer)) > 0)
+                {
+                }
+            }
+            else if (event.first == ListenFd)
+            {
+                acceptConnections();
+            }
+            else
+            {
+                auto owner = Owners.find(event.first);
+                if (owner != Owners.end() && (event.second & Readable) && event.first == owner->second)
+                {
+                    readQueries(*Connections[owner->second]);
+                }
+            }
+        }
+        for (auto const &entry : Connections)
+        {
+            if (!entry.second->Pollable)
+            {
+                readQueries(*entry.second);
+            }
+        }
+
+        for (auto entry = Connections.begin(); entry != Connections.end();)
+        {
+            Connection &connection = *entry->second;
+            writeReplies(connection);
+            DroppedConnection = DroppedConnection || connection.Failed;
+            if (connection.Failed || (connection.InputEnded && connection.Replies.empty() && connection.Output.empty()))
+            {
+                closeConnection(connection);
+                entry = Connections.erase(entry);
+                continue;
+            }
+            updateInterest(connection);
+            ++entry;
+        }
+    }
+}
+
+/**
+ * @brief Plans and formats the reply to one query line.
+ * Pins the current network for the whole query, so it can be called from several threads at once, also while the
+ * network is reloaded.
+ *
+ * @param line The query line, without its newline: "start city, start country -> destination city, destination country".
+ * @return The reply line, without its newline.
+ */
+std::string QueryServer::answer(const std::string &line)
+{
+    FlightQuery query;
+    std::size_t arrow = line.find("->");
+    if (arrow == std::string::npos || !splitPlace(line.substr(0, arrow), query.StartCity, query.StartCountry) ||
+        !splitPlace(line.substr(arrow + 2), query.DestinationCity, query.DestinationCountry))
+    {
+        return "ERROR expected \"city, country -> city, country\"";
+    }
+
+    std::shared_ptr<const Network> network = Network::current();
+    FlightPlan plan = ReadWrite::planFlight(*network, query);
+    if (!plan.Found)
+    {
+        return "NONE";
+    }
+    std::ostringstream reply;
+    reply << "OK " << plan.Distance << " " << plan.Legs.size() << " " << plan.Stops;
+    for (std::size_t i = 0; i < plan.Legs.size(); i++)
+    {
+        const FlightLeg &leg = plan.Legs[i];
+        if (i == 0)
+        {
+            reply << " " << network->ids().code(leg.Source).toString();
+        }
+        reply << " " << (leg.Airline.isValid() ? leg.Airline.toString() : "-") << " " << network->ids().code(leg.Destination).toString();
+    }
+    return reply.str();
+}
+
+/**
+ * @brief Serves queries on a Unix domain socket until the process is interrupted or terminated.
+ * A stale socket file left at the path is replaced; the socket file is removed when the server stops.
+ * A hangup signal reloads the network from its data files in the background, and a user signal 1 applies the route
+ * delta file to it; queries are answered from the previous network until the new one is published.
+ *
+ * @param path The path of the socket.
+ * @param threads The number of worker threads, or 0 to use every hardware thread.
+ * @param delta_filename The name of the route delta file, or an empty name if there is none.
+ * @return True if the server ran and stopped cleanly, false if the socket could not be set up.
+ */
+bool QueryServer::serveSocket(const std::string &path, unsigned threads, const std::string &delta_filename)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+    {
+        std::cout << "error starting server: the socket path is empty or too long" << std::endl;
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size());
+
+    // only a socket is ever replaced, never some other file that happens to have the name
+    struct stat status;
+    if (lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+    {
+        unlink(path.c_str());
+    }
+
+    QueryServer server(threads);
+    server.DeltaFilename = delta_filename;
+    server.ListenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server.ListenFd < 0 || server.WakePipe[0] < 0 || !setNonBlocking(server.ListenFd) ||
+        bind(server.ListenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(server.ListenFd, SOMAXCONN) != 0 || !server.watch(server.ListenFd, Readable))
+    {
+        std::cout << "error starting server: check that the socket directory is writable and no server is running" << std::endl;
+        return false;
+    }
+
+    StopRequested = 0;
+    ReloadRequested = 0;
+    DeltaRequested = 0;
+    SignalWakeFd = server.WakePipe[1];
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    signal(SIGHUP, requestReload);
+    signal(SIGUSR1, requestDelta);
+    std::cout << "> Serving queries on " << path << "..." << std::endl;
+
+    server.run();
+
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGHUP, SIG_DFL);
+    signal(SIGUSR1, SIG_DFL);
+    SignalWakeFd = -1;
+    Network::waitForReload();
+    unlink(path.c_str());
+    std::cout << "> Server stopped..." << std::endl;
+    return true;
+}
+
+/**
+ * @brief Serves queries read from standard input, writing the replies to standard output, until standard
+ * input ends and every query has been answered.
+ * Progress messages would mix with the replies, so none are printed; standard input and output are switched back to
+ * blocking mode before returning.
+ *
+ * @param threads The number of worker threads, or 0 to use every hardware thread.
+ * @return True if every reply was written, false otherwise.
+ */
+bool QueryServer::serveStream(unsigned threads)
+{
+    std::cout.flush();
+    int inputFlags = fcntl(STDIN_FILENO, F_GETFL);
+    int outputFlags = fcntl(STDOUT_FILENO, F_GETFL);
+    bool clean = false;
+    {
+        QueryServer server(threads);
+        if (server.WakePipe[0] >= 0 && setNonBlocking(STDIN_FILENO) && setNonBlocking(STDOUT_FILENO))
+        {
+            StopRequested = 0;
+            SignalWakeFd = server.WakePipe[1];
+            signal(SIGPIPE, SIG_IGN);
+            server.addConnection(STDIN_FILENO, STDOUT_FILENO);
+            server.run();
+            clean = !server.DroppedConnection;
+            SignalWakeFd = -1;
+        }
+    }
+    fcntl(STDIN_FILENO, F_SETFL, inputFlags);
+    fcntl(STDOUT_FILENO, F_SETFL, outputFlags);
+    return clean;
+}
@@ -0,0 +1,191 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include "../ThreadPool/thread_pool.h"
+#include "../ReadWrite/read_write.h"
+
+/**
+ * @class QueryServer
+ * @brief Answers flight plan queries against the loaded network for as long as the process runs.
+ *
+ * Queries arrive one per line, either on a Unix domain socket or on standard input, in the form
+ * "start city, start country -> destination city, destination country". Every query gets exactly one reply line,
+ * in the order the queries were sent on that connection:
+ * - "OK <distance> <flights> <stops> <airport> <airline> <airport> ..." for a route, naming the airline of each
+ *   flight between the airports it joins ("-" if none is known);
+ * - "NONE" if either city has no airports or no route joins them;
+ * - "ERROR <reason>" if the line is not a query.
+ *
+ * One thread runs an event loop (epoll on Linux, poll elsewhere) that accepts connections, reads query lines and
+ * writes replies without ever blocking; the queries themselves are planned on a thread pool. Workers hand finished
+ * replies back to the loop through a pipe the loop watches alongside the connections.
+ */
+class QueryServer
+{
+
+private:
+    /**
+     * @struct Reply
+     * @brief The reply to one query, filled in by a worker.
+     */
+    struct Reply
+    {
+        bool Ready = false; /**< Set by the worker once Text holds the reply. */
+        std::string Text; /**< The reply line, without its newline. */
+    };
+
+    /**
+     * @struct Connection
+     * @brief One client: a socket, or standard input and output.
+     */
+    struct Connection
+    {
+        int InputFd = -1; /**< The descriptor queries are read from. */
+        int OutputFd = -1; /**< The descriptor replies are written to; the same as InputFd for a socket. */
+        bool Pollable = true; /**< False if InputFd is a regular file, which the event loop cannot watch. */
+        bool InputEnded = false; /**< Set once the client has sent its last query. */
+        bool Failed = false; /**< Set if reading or writing failed; the connection is dropped. */
+        std::string Input; /**< Received bytes not yet forming a whole line. */
+        std::string Output; /**< Reply bytes not yet written. */
+        std::size_t OutputSent = 0; /**< The number of bytes of Output already written. */
+        std::deque<std::shared_ptr<Reply>> Replies; /**< The replies still owed, in query order. */
+    };
+
+    ThreadPool Workers; /**< The threads queries are planned on. */
+    std::mutex ReplyMutex; /**< Guards the Ready and Text of every reply. */
+    int WakePipe[2]; /**< Workers write a byte to the second descriptor to wake the event loop. */
+    int ListenFd; /**< The listening socket, or -1 when serving standard input. */
+    int Poller; /**< The epoll descriptor; unused where the loop runs on poll. */
+    std::map<int, std::uint32_t> Interests; /**< The events watched on every descriptor the loop watches. */
+    std::map<int, std::unique_ptr<Connection>> Connections; /**< The open connections, by input descriptor. */
+    std::map<int, int> Owners; /**< The input descriptor of the connection every watched descriptor belongs to. */
+    bool DroppedConnection; /**< Set when a connection is dropped because reading or writing failed. */
+    std::string DeltaFilename; /**< The route delta file applied on request, or an empty name if there is none. */
+
+    /**
+     * @brief Creates the wake pipe, the poller and the thread pool.
+     *
+     * @param threads The number of worker threads, or 0 to use every hardware thread.
+     */
+    explicit QueryServer(unsigned threads);
+
+    /**
+     * @brief Waits for the queued queries, then closes every connection, the wake pipe and the poller.
+     */
+    ~QueryServer();
+
+    QueryServer(const QueryServer &) = delete;
+    QueryServer &operator=(const QueryServer &) = delete;
+
+    /**
+     * @brief Watches a descriptor for the given events, or stops watching it if there are none.
+     *
+     * @param fd The descriptor.
+     * @param events The events to watch, as a mask of the Readable and Writable flags.
+     * @return True if the descriptor is watched as asked, false if it cannot be watched (such as a regular file).
+     */
+    bool watch(int fd, std::uint32_t events);
+
+    /**
+     * @brief Waits until a watched descriptor is ready.
+     *
+     * @param timeout The longest time to wait in milliseconds, or -1 to wait for ever.
+     * @param ready Receives every ready descriptor and its ready events.
+     */
+    void wait(int timeout, std::vector<std::pair<int, std::uint32_t>> &ready);
+
+    /**
+     * @brief Starts serving a connection.
+     *
+     * @param inputFd The descriptor queries are read from; must be non-blocking unless it is a regular file.
+     * @param outputFd The descriptor replies are written to; must be non-blocking unless it is a regular file.
+     */
+    void addConnection(int inputFd, int outputFd);
+
+    /**
+     * @brief Accepts every connection waiting on the listening socket.
+     */
+    void acceptConnections();
+
+    /**
+     * @brief Reads what a connection has sent and queues a worker task for every whole query line.
+     *
+     * @param connection The connection.
+     */
+    void readQueries(Connection &connection);
+
+    /**
+     * @brief Moves the finished replies at the front of a connection's queue to its output and writes as much as
+     * the descriptor takes.
+     *
+     * @param connection The connection.
+     */
+    void writeReplies(Connection &connection);
+
+    /**
+     * @brief Updates the events watched for a connection from its state.
+     *
+     * @param connection The connection.
+     */
+    void updateInterest(Connection &connection);
+
+    /**
+     * @brief Stops watching a connection and closes its descriptors.
+     *
+     * @param connection The connection.
+     */
+    void closeConnection(Connection &connection);
+
+    /**
+     * @brief Runs the event loop until a stop is requested, or, when serving standard input, until every query has
+     * been answered.
+     */
+    void run();
+
+public:
+    /**
+     * @brief Plans and formats the reply to one query line.
+     * Pins the current network for the whole query, so it can be called from several threads at once, also while the
+     * network is reloaded.
+     *
+     * @param line The query line, without its newline.
+     * @return The reply line, without its newline.
+     */
+    static std::string answer(const std::string &line);
+
+    /**
+     * @brief Serves queries on a Unix domain socket until the process is interrupted or terminated.
+     * A stale socket file left at the path is replaced; the socket file is removed when the server stops.
+     * A hangup signal reloads the network from its data files in the background, and a user signal 1 applies the
+     * route delta file to it; queries are answered from the previous network until the new one is published. A
+     * signal that arrives while a reload or update is still running is acted on once it has finished.
+     *
+     * @param path The path of the socket.
+     * @param threads The number of worker threads, or 0 to use every hardware thread.
+     * @param delta_filename The name of the route delta file, or an empty name if there is none.
+     * @return True if the server ran and stopped cleanly, false if the socket could not be set up.
+     */
+    static bool serveSocket(const std::string &path, unsigned threads = 0, const std::string &delta_filename = "");
+
+    /**
+     * @brief Serves queries read from standard input, writing the replies to standard output, until standard
+     * input ends and every query has been answered.
+     *
+     * @param threads The number of worker threads, or 0 to use every hardware thread.
+     * @return True if every reply was written, false otherwise.
+     */
+    static bool serveStream(unsigned threads = 0);
+};
+
+#endif // QUERY_SERVER_H
@@ -0,0 +1,410 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include "snapshot.h"
+#include "../Iata/iata.h"
+#include "../Routes/routes.h"
+#include "../Airports/airports.h"
+#include "../Mmap/mapped_file.h"
+#include "../Hierarchy/contraction_hierarchy.h"
+
+const std::uint32_t Snapshot::FormatVersion = 5;
+
+/**
+ * @brief Reads the size and modification time of a data file.
+ * The time is read to the nanosecond where the system keeps it, so a same-size edit within the second the snapshot
+ * was written from still makes the snapshot stale.
+ *
+ * @param filename The name of the file.
+ * @param source Receives the size and modification time.
+ * @return True if the file exists, false otherwise.
+ */
+bool Snapshot::sourceOf(const std::string &filename, SnapshotSource &source)
+{
+    struct stat status;
+    if (stat(filename.c_str(), &status) != 0)
+    {
+        return false;
+    }
+    source.Size = static_cast<std::uint64_t>(status.st_size);
+    source.Modified = static_cast<std::int64_t>(status.st_mtime);
+#if defined(__APPLE__)
+    source.ModifiedNanoseconds = static_cast<std::int64_t>(status.st_mtimespec.tv_nsec);
+#elif defined(__linux__)
+    source.ModifiedNanoseconds = static_cast<std::int64_t>(status.st_mtim.tv_nsec);
+#else
+    source.ModifiedNanoseconds = 0;
+#endif
+    return true;
+}
+
+/**
+ * @brief Appends a section to a snapshot being written, padded to an 8 byte boundary.
+ *
+ * @param buffer The snapshot being written.
+ * @param data The contents of the section.
+ * @param bytes The size of the section in bytes.
+ * @return The byte offset of the section.
+ */
+std::uint64_t Snapshot::appendSection(std::vector<char> &buffer, const void *data, std::size_t bytes)
+{
+    buffer.resize((buffer.size() + 7) / 8 * 8, '\0');
+    std::uint64_t offset = buffer.size();
+    const char *begin = static_cast<const char *>(data);
+    buffer.insert(buffer.end(), begin, begin + bytes);
+    return offset;
+}
+
+/**
+ * @brief Checks that a section of a mapped snapshot lies inside the file.
+ *
+ * @param header The header of the snapshot.
+ * @param fileSize The size of the snapshot file in bytes.
+ * @param section The section to check.
+ * @param bytes The size the section should have.
+ * @return True if the whole section is inside the file, false otherwise.
+ */
+bool Snapshot::sectionFits(const SnapshotHeader &header, std::size_t fileSize, SnapshotHeader::Section section, std::uint64_t bytes)
+{
+    std::uint64_t offset = header.Sections[section];
+    return offset % 8 == 0 && offset <= fileSize && bytes <= fileSize - offset;
+}
+
+/**
+ * @brief Writes the currently loaded network to a snapshot file.
+ *
+ * The snapshot is written to a temporary file first and then renamed over the old snapshot, so a
+ * process starting at the same time never maps a half-written file.
+ *
+ * @param snapshot_filename The name of the snapshot file to write.
+ * @param airport_filename The airport file the network was loaded from.
+ * @param route_filename The route file the network was loaded from.
+ * @return True if the snapshot was written, false otherwise.
+ */
+bool Snapshot::write(const std::string &snapshot_filename, const std::string &airport_filename, const std::string &route_filename)
+{
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, "AERONAV", 8);
+    header.Version = FormatVersion;
+    if (!sourceOf(airport_filename, header.AirportSource) || !sourceOf(route_filename, header.RouteSource))
+    {
+        return false;
+    }
+
+    const IataTable &ids = Airport::AirportIds;
+    header.AirportCount = ids.size();
+
+    std::vector<std::uint32_t> codes(ids.size());
+    for (std::uint32_t id = 0; id < ids.size(); id++)
+    {
+        codes[id] = ids.code(id).packed();
+    }
+
+    // airport records, with their text in the string section
+    std::vector<char> strings;
+    auto addString = [&strings](const std::string &text)
+    {
+        std::uint32_t offset = static_cast<std::uint32_t>(strings.size());
+        strings.insert(strings.end(), text.begin(), text.end());
+        strings.push_back('\0');
+        return offset;
+    };
+    std::vector<SnapshotAirport> airports;
+    airports.reserve(Airport::AirportMap.size());
+    for (auto const &pair : Airport::AirportMap)
+    {
+        const Airport &airport = pair.second;
+        SnapshotAirport record;
+        record.Id = ids.find(pair.first);
+        record.Name = addString(airport.getAirportName());
+        record.City = addString(airport.getAirportCity());
+        record.Country = addString(airport.getCountry());
+        record.Latitude = airport.getLatitude();
+        record.Longitude = airport.getLongitude();
+        airports.push_back(record);
+    }
+    header.AirportRecordCount = static_cast<std::uint32_t>(airports.size());
+    header.StringBytes = strings.size();
+
+    // route lists of AirportRoutesMap, indexed by airport id
+    std::vector<const std::vector<IataCode> *> rows(ids.size(), nullptr);
+    for (auto const &pair : Route::AirportRoutesMap)
+    {
+        rows[ids.find(pair.first)] = &pair.second;
+    }
+    std::vector<std::uint32_t> routeOffsets(ids.size() + 1, 0);
+    std::vector<std::uint32_t> routeDestinations;
+    for (std::uint32_t id = 0; id < ids.size(); id++)
+    {
+        if (rows[id] != nullptr)
+        {
+            for (auto const &destination : *rows[id])
+            {
+                routeDestinations.push_back(ids.find(destination));
+            }
+        }
+        routeOffsets[id + 1] = static_cast<std::uint32_t>(routeDestinations.size());
+    }
+    header.RouteCount = routeDestinations.size();
+    header.GraphEdgeCount = Route::RouteGraph.routeCount();
+
+    // keys of AirlineRoutesMap followed by a sentinel, and their destinations
+    std::vector<SnapshotAirlineKey> airlineKeys;
+    std::vector<std::uint32_t> airlineDestinations;
+    for (auto const &pair : Route::AirlineRoutesMap)
+    {
+        SnapshotAirlineKey key;
+        key.Airline = pair.first.Airline.packed();
+        key.Source = ids.find(pair.first.Source);
+        key.Stops = pair.first.Stops;
+        key.Begin = static_cast<std::uint32_t>(airlineDestinations.size());
+        airlineKeys.push_back(key);
+        for (auto const &destination : pair.second)
+        {
+            airlineDestinations.push_back(ids.find(destination));
+        }
+    }
+    header.AirlineKeyCount = static_cast<std::uint32_t>(airlineKeys.size());
+    header.AirlineRouteCount = airlineDestinations.size();
+    SnapshotAirlineKey sentinel;
+    memset(&sentinel, 0, sizeof(sentinel));
+    sentinel.Begin = static_cast<std::uint32_t>(airlineDestinations.size());
+    airlineKeys.push_back(sentinel);
+
+    const ContractionHierarchy &hierarchy = Route::RouteHierarchy;
+    header.HierarchyAirportCount = hierarchy.airportCount();
+    header.UpEdgeCount = hierarchy.upEdges().size();
+    header.DownEdgeCount = hierarchy.downEdges().size();
+
+    std::vector<char> buffer(sizeof(header), '\0');
+    header.Sections[SnapshotHeader::Codes] = appendSection(buffer, codes.data(), codes.size() * sizeof(std::uint32_t));
+    header.Sections[SnapshotHeader::Airports] = appendSection(buffer, airports.data(), airports.size() * sizeof(SnapshotAirport));
+    header.Sections[SnapshotHeader::RouteOffsets] = appendSection(buffer, routeOffsets.data(), routeOffsets.size() * sizeof(std::uint32_t));
+    header.Sections[SnapshotHeader::RouteDestinations] = appendSection(buffer, routeDestinations.data(), routeDestinations.size() * sizeof(std::uint32_t));
+    header.Sections[SnapshotHeader::GraphOffsets] = appendSection(buffer, Route::RouteGraph.offsets().data(), Route::RouteGraph.offsets().size() * sizeof(std::uint32_t));
+    header.Sections[SnapshotHeader::GraphNeighbors] = appendSection(buffer, Route::RouteGraph.neighbors().data(), Route::RouteGraph.neighbors().size() * sizeof(std::uint32_t));
+    header.Sections[SnapshotHeader::AirlineKeys] = appendSection(buffer, airlineKeys.data(), airlineKeys.size() * sizeof(SnapshotAirlineKey));
+    header.Sections[SnapshotHeader::AirlineDestinations] = appendSection(buffer, airlineDestinations.data(), airlineDestinations.size() * sizeof(std::uint32_t));
+    header.Sections[SnapshotHeader::HierarchyRanks] = appendSection(buffer, hierarchy.ranks().data(), hierarchy.ranks().size() * sizeof(std::uint32_t));
+    header.Sections[SnapshotHeader::UpOffsets] = appendSection(buffer, hierarchy.upOffsets().data(), hierarchy.upOffsets().size() * sizeof(std::uint32_t));
+    header.Sections[SnapshotHeader::UpEdges] = appendSection(buffer, hierarchy.upEdges().data(), hierarchy.upEdges().size() * sizeof(HierarchyEdge));
+    header.Sections[SnapshotHeader::DownOffsets] = appendSection(buffer, hierarchy.downOffsets().data(), hierarchy.downOffsets().size() * sizeof(std::uint32_t));
+    header.Sections[SnapshotHeader::DownEdges] = appendSection(buffer, hierarchy.downEdges().data(), hierarchy.downEdges().size() * sizeof(HierarchyEdge));
+    header.Sections[SnapshotHeader::Strings] = appendSection(buffer, strings.data(), strings.size());
+    memcpy(buffer.data(), &header, sizeof(header));
+
+    std::string temporary_filename = snapshot_filename + ".tmp";
+    std::ofstream outputStream(temporary_filename, std::ios::binary | std::ios::trunc);
+    outputStream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    outputStream.close();
+    if (!outputStream || std::rename(temporary_filename.c_str(), snapshot_filename.c_str()) != 0)
+    {
+        std::remove(temporary_filename.c_str());
+        std::cout << "error writing network snapshot: check that the snapshot directory is writable" << std::endl;
+        return false;
+    }
+
+    std::cout << "> Network snapshot written..." << std::endl;
+    return true;
+}
+
+/**
+ * @brief Loads the network from a snapshot file, if it is present and up to date.
+ *
+ * Nothing is loaded if the snapshot is missing, was written by another format version, is damaged, or was
+ * written from data files that have changed since.
+ *
+ * @param snapshot_filename The name of the snapshot file to read.
+ * @param airport_filename The airport file the snapshot must have been written from.
+ * @param route_filename The route file the snapshot must have been written from.
+ * @return True if the network was loaded, false if the CSV files have to be read instead.
+ */
+bool Snapshot::load(const std::string &snapshot_filename, const std::string &airport_filename, const std::string &route_filename)
+{
+    SnapshotSource airportSource;
+    SnapshotSource routeSource;
+    MappedFile file;
+    if (!sourceOf(airport_filename, airportSource) || !sourceOf(route_filename, routeSource) || !file.open(snapshot_filename))
+    {
+        return false;
+    }
+
+    SnapshotHeader header;
+    if (file.size() < sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+
+    // only use a snapshot of this format, written from the current data files
+    if (memcmp(header.Magic, "AERONAV", 8) != 0 || header.Version != FormatVersion ||
+        header.AirportSource.Size != airportSource.Size || header.AirportSource.Modified != airportSource.Modified ||
+        header.AirportSource.ModifiedNanoseconds != airportSource.ModifiedNanoseconds ||
+        header.RouteSource.Size != routeSource.Size || header.RouteSource.Modified != routeSource.Modified ||
+        header.RouteSource.ModifiedNanoseconds != routeSource.ModifiedNanoseconds)
+    {
+        return false;
+    }
+
+    std::uint64_t offsetCount = static_cast<std::uint64_t>(header.AirportCount) + 1;
+    if (!sectionFits(header, file.size(), SnapshotHeader::Codes, header.AirportCount * sizeof(std::uint32_t)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::Airports, header.AirportRecordCount * sizeof(SnapshotAirport)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::RouteOffsets, offsetCount * sizeof(std::uint32_t)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::RouteDestinations, header.RouteCount * sizeof(std::uint32_t)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::GraphOffsets, offsetCount * sizeof(std::uint32_t)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::GraphNeighbors, header.GraphEdgeCount * sizeof(std::uint32_t)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::AirlineKeys, (header.AirlineKeyCount + 1ull) * sizeof(SnapshotAirlineKey)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::AirlineDestinations, header.AirlineRouteCount * sizeof(std::uint32_t)) ||
+        (header.HierarchyAirportCount != 0 && header.HierarchyAirportCount != header.AirportCount) ||
+        !sectionFits(header, file.size(), SnapshotHeader::HierarchyRanks, header.HierarchyAirportCount * sizeof(std::uint32_t)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::UpOffsets, (header.HierarchyAirportCount + 1ull) * sizeof(std::uint32_t)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::UpEdges, header.UpEdgeCount * sizeof(HierarchyEdge)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::DownOffsets, (header.HierarchyAirportCount + 1ull) * sizeof(std::uint32_t)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::DownEdges, header.DownEdgeCount * sizeof(HierarchyEdge)) ||
+        !sectionFits(header, file.size(), SnapshotHeader::Strings, header.StringBytes))
+    {
+        return false;
+    }
+
+    // sections are 8 byte aligned within a page aligned mapping, so they can be read in place
+    const char *data = file.data();
+    const std::uint32_t *codes = reinterpret_cast<const std::uint32_t *>(data + header.Sections[SnapshotHeader::Codes]);
+    const SnapshotAirport *airports = reinterpret_cast<const SnapshotAirport *>(data + header.Sections[SnapshotHeader::Airports]);
+    const std::uint32_t *routeOffsets = reinterpret_cast<const std::uint32_t *>(data + header.Sections[SnapshotHeader::RouteOffsets]);
+    const std::uint32_t *routeDestinations = reinterpret_cast<const std::uint32_t *>(data + header.Sections[SnapshotHeader::RouteDestinations]);
+    const std::uint32_t *graphOffsets = reinterpret_cast<const std::uint32_t *>(data + header.Sections[SnapshotHeader::GraphOffsets]);
+    const std::uint32_t *graphNeighbors = reinterpret_cast<const std::uint32_t *>(data + header.Sections[SnapshotHeader::GraphNeighbors]);
+    const SnapshotAirlineKey *airlineKeys = reinterpret_cast<const SnapshotAirlineKey *>(data + header.Sections[SnapshotHeader::AirlineKeys]);
+    const std::uint32_t *airlineDestinations = reinterpret_cast<const std::uint32_t *>(data + header.Sections[SnapshotHeader::AirlineDestinations]);
+    const std::uint32_t *hierarchyRanks = reinterpret_cast<const std::uint32_t *>(data + header.Sections[SnapshotHeader::HierarchyRanks]);
+    const std::uint32_t *upOffsets = reinterpret_cast<const std::uint32_t *>(data + header.Sections[SnapshotHeader::UpOffsets]);
+    const HierarchyEdge *upEdges = reinterpret_cast<const HierarchyEdge *>(data + header.Sections[SnapshotHeader::UpEdges]);
+    const std::uint32_t *downOffsets = reinterpret_cast<const std::uint32_t *>(data + header.Sections[SnapshotHeader::DownOffsets]);
+    const HierarchyEdge *downEdges = reinterpret_cast<const HierarchyEdge *>(data + header.Sections[SnapshotHeader::DownEdges]);
+    const char *strings = data + header.Sections[SnapshotHeader::Strings];
+
+    if (routeOffsets[header.AirportCount] != header.RouteCount || graphOffsets[header.AirportCount] != header.GraphEdgeCount ||
+        airlineKeys[header.AirlineKeyCount].Begin != header.AirlineRouteCount ||
+        upOffsets[header.HierarchyAirportCount] != header.UpEdgeCount || downOffsets[header.HierarchyAirportCount] != header.DownEdgeCount ||
+        (header.StringBytes > 0 && strings[header.StringBytes - 1] != '\0'))
+    {
+        return false;
+    }
+
+    // every id and string offset must point inside the snapshot before anything is replaced
+    bool valid = true;
+    for (std::uint32_t i = 0; i < header.AirportRecordCount; i++)
+    {
+        const SnapshotAirport &record = airports[i];
+        valid = valid && record.Id < header.AirportCount && record.Name < header.StringBytes && record.City < header.StringBytes &&
+                record.Country < header.StringBytes;
+    }
+    for (std::uint64_t i = 0; i < header.RouteCount; i++)
+    {
+        valid = valid && routeDestinations[i] < header.AirportCount;
+    }
+    for (std::uint64_t i = 0; i < header.GraphEdgeCount; i++)
+    {
+        valid = valid && graphNeighbors[i] < header.AirportCount;
+    }
+    for (std::uint64_t i = 0; i < header.AirlineRouteCount; i++)
+    {
+        valid = valid && airlineDestinations[i] < header.AirportCount;
+    }
+    for (std::uint32_t id = 0; id < header.AirportCount; id++)
+    {
+        valid = valid && routeOffsets[id] <= routeOffsets[id + 1] && graphOffsets[id] <= graphOffsets[id + 1];
+    }
+    for (std::uint32_t k = 0; k < header.AirlineKeyCount; k++)
+    {
+        valid = valid && airlineKeys[k].Source < header.AirportCount && airlineKeys[k].Begin <= airlineKeys[k + 1].Begin;
+    }
+    for (std::uint32_t id = 0; id < header.HierarchyAirportCount; id++)
+    {
+        valid = valid && upOffsets[id] <= upOffsets[id + 1] && downOffsets[id] <= downOffsets[id + 1];
+    }
+    for (std::uint64_t i = 0; i < header.UpEdgeCount; i++)
+    {
+        valid = valid && upEdges[i].Target < header.AirportCount && (upEdges[i].Middle < header.AirportCount || upEdges[i].Middle == IataTable::NoId);
+    }
+    for (std::uint64_t i = 0; i < header.DownEdgeCount; i++)
+    {
+        valid = valid && downEdges[i].Target < header.AirportCount && (downEdges[i].Middle < header.AirportCount || downEdges[i].Middle == IataTable::NoId);
+    }
+    if (!valid)
+    {
+        return false;
+    }
+
+    Airport::AirportIds.clear();
+    Airport::AirportMap.clear();
+    Route::AirportRoutesMap.clear();
+    Route::AirlineRoutesMap.clear();
+
+    for (std::uint32_t id = 0; id < header.AirportCount; id++)
+    {
+        Airport::AirportIds.intern(IataCode::fromPacked(codes[id]));
+    }
+    if (Airport::AirportIds.size() != header.AirportCount)
+    {
+        Airport::AirportIds.clear();
+        return false;
+    }
+
+    // airports are stored in key order, so each one is inserted at the end of the map
+    for (std::uint32_t i = 0; i < header.AirportRecordCount; i++)
+    {
+        const SnapshotAirport &record = airports[i];
+        IataCode code = Airport::AirportIds.code(record.Id);
+        Airport airport(strings + record.Name, strings + record.City, strings + record.Country, code,
+                        record.Latitude, record.Longitude);
+        Airport::AirportMap.emplace_hint(Airport::AirportMap.end(), code, airport);
+    }
+    Airport::buildCityIndex();
+    Airport::buildLocationIndex();
+
+    for (std::uint32_t id = 0; id < header.AirportCount; id++)
+    {
+        if (routeOffsets[id] == routeOffsets[id + 1])
+        {
+            continue;
+        }
+        std::vector<IataCode> &routelist = Route::AirportRoutesMap[Airport::AirportIds.code(id)];
+        routelist.reserve(routeOffsets[id + 1] - routeOffsets[id]);
+        for (std::uint32_t i = routeOffsets[id]; i < routeOffsets[id + 1]; i++)
+        {
+            routelist.push_back(Airport::AirportIds.code(routeDestinations[i]));
+        }
+    }
+
+    for (std::uint32_t k = 0; k < header.AirlineKeyCount; k++)
+    {
+        AirlineRouteKey key{IataCode::fromPacked(airlineKeys[k].Airline), Airport::AirportIds.code(airlineKeys[k].Source), airlineKeys[k].Stops};
+        std::vector<IataCode> &routelist = Route::AirlineRoutesMap.emplace_hint(Route::AirlineRoutesMap.end(), key, std::vector<IataCode>())->second;
+        routelist.reserve(airlineKeys[k + 1].Begin - airlineKeys[k].Begin);
+        for (std::uint32_t i = airlineKeys[k].Begin; i < airlineKeys[k + 1].Begin; i++)
+        {
+            routelist.push_back(Airport::AirportIds.code(airlineDestinations[i]));
+        }
+    }
+
+    Route::RouteGraph = FlightGraph::fromArrays(graphOffsets, header.AirportCount, graphNeighbors);
+    Route::RouteHierarchy = ContractionHierarchy();
+    if (header.HierarchyAirportCount != 0)
+    {
+        Route::RouteHierarchy = ContractionHierarchy::fromArrays(hierarchyRanks, header.HierarchyAirportCount, upOffsets, upEdges, downOffsets, downEdges);
+    }
+
+    std::cout << "> Network snapshot loaded..." << std::endl;
+    Route::weighRouteGraph();
+    Route::buildAirlineIndex();
+    return true;
+}
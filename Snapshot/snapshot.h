@@ -0,0 +1,181 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @struct SnapshotSource
+ * @brief Identifies the version of a data file a snapshot was written from.
+ */
+struct SnapshotSource
+{
+    std::uint64_t Size; /**< The size of the file in bytes. */
+    std::int64_t Modified; /**< The last modification time of the file, in seconds since the epoch. */
+    std::int64_t ModifiedNanoseconds; /**< The nanoseconds of the modification time, or 0 where the system does not keep them. */
+};
+
+/**
+ * @struct SnapshotHeader
+ * @brief The fixed-size header at the start of a snapshot file.
+ *
+ * The header is followed by the sections listed in Sections, each starting at an 8 byte aligned offset:
+ * - Codes: the packed IATA code of every airport id (uint32 x AirportCount).
+ * - Airports: one SnapshotAirport per airport of the airport file, in IATA code order.
+ * - RouteOffsets / RouteDestinations: the route lists of AirportRoutesMap in CSR form, indexed by airport id
+ *   (uint32 x AirportCount + 1, uint32 airport ids x RouteCount), duplicates and file order kept.
+ * - GraphOffsets / GraphNeighbors: the arrays of the route graph (uint32 x AirportCount + 1, uint32 x GraphEdgeCount).
+ * - AirlineKeys / AirlineDestinations: the keys of AirlineRoutesMap in key order plus a sentinel key
+ *   (SnapshotAirlineKey x AirlineKeyCount + 1), and their destinations (uint32 airport ids x AirlineRouteCount).
+ * - HierarchyRanks / UpOffsets / UpEdges / DownOffsets / DownEdges: the arrays of the contraction hierarchy
+ *   (uint32 x HierarchyAirportCount, uint32 x HierarchyAirportCount + 1, HierarchyEdge x UpEdgeCount, and the same
+ *   for the downward edges). HierarchyAirportCount is 0 if no hierarchy was built.
+ * - Strings: NUL terminated airport names, cities and countries, referenced by byte offset.
+ *
+ * All values are stored in the byte order of the machine that wrote the snapshot.
+ */
+struct SnapshotHeader
+{
+    /**
+     * @brief The sections of a snapshot, in file order.
+     */
+    enum Section
+    {
+        Codes,
+        Airports,
+        RouteOffsets,
+        RouteDestinations,
+        GraphOffsets,
+        GraphNeighbors,
+        AirlineKeys,
+        AirlineDestinations,
+        HierarchyRanks,
+        UpOffsets,
+        UpEdges,
+        DownOffsets,
+        DownEdges,
+        Strings,
+        SectionCount
+    };
+
+    char Magic[8]; /**< Always "AERONAV" followed by a NUL. */
+    std::uint32_t Version; /**< The format version the snapshot was written with. */
+    std::uint32_t AirportCount; /**< The number of airport ids. */
+    std::uint32_t AirportRecordCount; /**< The number of airports from the airport file. */
+    std::uint32_t AirlineKeyCount; /**< The number of keys of AirlineRoutesMap. */
+    std::uint32_t HierarchyAirportCount; /**< The number of airports in the contraction hierarchy; 0 or AirportCount. */
+    std::uint64_t RouteCount; /**< The number of routes in AirportRoutesMap. */
+    std::uint64_t GraphEdgeCount; /**< The number of edges of the route graph. */
+    std::uint64_t AirlineRouteCount; /**< The number of destinations in AirlineRoutesMap. */
+    std::uint64_t UpEdgeCount; /**< The number of upward edges of the contraction hierarchy. */
+    std::uint64_t DownEdgeCount; /**< The number of downward edges of the contraction hierarchy. */
+    std::uint64_t StringBytes; /**< The size of the string section. */
+    SnapshotSource AirportSource; /**< The airport file the snapshot was written from. */
+    SnapshotSource RouteSource; /**< The route file the snapshot was written from. */
+    std::uint64_t Sections[SectionCount]; /**< The byte offset of every section. */
+};
+
+/**
+ * @struct SnapshotAirport
+ * @brief The saved form of one airport; text fields are byte offsets into the string section, coordinates are stored parsed.
+ */
+struct SnapshotAirport
+{
+    std::uint32_t Id; /**< The airport id. */
+    std::uint32_t Name; /**< The name of the airport. */
+    std::uint32_t City; /**< The city of the airport. */
+    std::uint32_t Country; /**< The country of the airport. */
+    double Latitude; /**< The latitude of the airport in degrees, or NaN if unknown. */
+    double Longitude; /**< The longitude of the airport in degrees, or NaN if unknown. */
+};
+
+/**
+ * @struct SnapshotAirlineKey
+ * @brief The saved form of one key of AirlineRoutesMap.
+ */
+struct SnapshotAirlineKey
+{
+    std::uint32_t Airline; /**< The packed airline code. */
+    std::uint32_t Source; /**< The id of the source airport. */
+    std::int32_t Stops; /**< The number of stops. */
+    std::uint32_t Begin; /**< The index of the key's first destination in the destination section. */
+};
+
+/**
+ * @class Snapshot
+ * @brief Saves the loaded network to a versioned binary file and loads it back without parsing any text.
+ *
+ * A snapshot holds everything the CSV readers build: the airport id table, Airport::AirportMap,
+ * Route::AirportRoutesMap, Route::AirlineRoutesMap, Route::RouteGraph and Route::RouteHierarchy. It is loaded by
+ * mapping the file into memory and copying the arrays out of it. A snapshot records the size and modification time
+ * of the data files it was written from and is only used while they are unchanged.
+ */
+class Snapshot
+{
+
+private:
+    /**
+     * @brief Reads the size and modification time of a data file.
+     *
+     * @param filename The name of the file.
+     * @param source Receives the size and modification time.
+     * @return True if the file exists, false otherwise.
+     */
+    static bool sourceOf(const std::string &filename, SnapshotSource &source);
+
+    /**
+     * @brief Appends a section to a snapshot being written, padded to an 8 byte boundary.
+     *
+     * @param buffer The snapshot being written.
+     * @param data The contents of the section.
+     * @param bytes The size of the section in bytes.
+     * @return The byte offset of the section.
+     */
+    static std::uint64_t appendSection(std::vector<char> &buffer, const void *data, std::size_t bytes);
+
+    /**
+     * @brief Checks that a section of a mapped snapshot lies inside the file.
+     *
+     * @param header The header of the snapshot.
+     * @param fileSize The size of the snapshot file in bytes.
+     * @param section The section to check.
+     * @param bytes The size the section should have.
+     * @return True if the whole section is inside the file, false otherwise.
+     */
+    static bool sectionFits(const SnapshotHeader &header, std::size_t fileSize, SnapshotHeader::Section section, std::uint64_t bytes);
+
+public:
+    /**
+     * @brief The format version written by this version of the program. Snapshots of other versions are not loaded.
+     */
+    static const std::uint32_t FormatVersion;
+
+    /**
+     * @brief Writes the currently loaded network to a snapshot file.
+     *
+     * @param snapshot_filename The name of the snapshot file to write.
+     * @param airport_filename The airport file the network was loaded from.
+     * @param route_filename The route file the network was loaded from.
+     * @return True if the snapshot was written, false otherwise.
+     */
+    static bool write(const std::string &snapshot_filename, const std::string &airport_filename, const std::string &route_filename);
+
+    /**
+     * @brief Loads the network from a snapshot file, if it is present and up to date.
+     *
+     * Nothing is loaded if the snapshot is missing, was written by another format version, is damaged, or was
+     * written from data files that have changed since.
+     *
+     * @param snapshot_filename The name of the snapshot file to read.
+     * @param airport_filename The airport file the snapshot must have been written from.
+     * @param route_filename The route file the snapshot must have been written from.
+     * @return True if the network was loaded, false if the CSV files have to be read instead.
+     */
+    static bool load(const std::string &snapshot_filename, const std::string &airport_filename, const std::string &route_filename);
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,262 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "airport_tree.h"
+
+static const double EarthRadius = 6371.0;
+
+/**
+ * @brief Gets the squared straight-line distance between two coordinate triples.
+ */
+static double squaredDistance(const double *a, const double *b)
+{
+    double x = a[0] - b[0];
+    double y = a[1] - b[1];
+    double z = a[2] - b[2];
+    return x * x + y * y + z * z;
+}
+
+/**
+ * @brief Default constructor for the AirportTree class.
+ * Creates an empty tree.
+ */
+AirportTree::AirportTree()
+{
+}
+
+/**
+ * @brief Converts a position in degrees to a point on the unit sphere.
+ *
+ * @param lat The latitude in degrees.
+ * @param lon The longitude in degrees.
+ * @param id The id of the airport at the position.
+ * @return The point.
+ */
+AirportTree::TreePoint AirportTree::toPoint(double lat, double lon, std::uint32_t id)
+{
+    double latitude = lat * M_PI / 180.0;
+    double longitude = lon * M_PI / 180.0;
+    TreePoint point;
+    point.Coordinates[0] = cos(latitude) * cos(longitude);
+    point.Coordinates[1] = cos(latitude) * sin(longitude);
+    point.Coordinates[2] = sin(latitude);
+    point.Id = id;
+    return point;
+}
+
+/**
+ * @brief Builds a tree over the positions of a set of airports.
+ * Airports with a NaN coordinate have no position and are left out.
+ *
+ * @param ids The ids of the airports.
+ * @param latitudes The latitude of every airport in degrees, parallel to ids.
+ * @param longitudes The longitude of every airport in degrees, parallel to ids.
+ * @return The tree.
+ */
+AirportTree AirportTree::build(const std::vector<std::uint32_t> &ids, const std::vector<double> &latitudes, const std::vector<double> &longitudes)
+{
+    AirportTree tree;
+    for (std::size_t i = 0; i < ids.size(); i++)
+    {
+        if (!std::isnan(latitudes[i]) && !std::isnan(longitudes[i]))
+        {
+            tree.Points.push_back(toPoint(latitudes[i], longitudes[i], ids[i]));
+        }
+    }
+    tree.Axes.assign(tree.Points.size(), 0);
+    tree.split(0, tree.Points.size());
+    return tree;
+}
+
+/**
+ * @brief Orders one range of the tree arrays around its middle element, then orders both halves.
+ * The range is split on the axis along which its points are most spread out.
+ *
+ * @param begin The first element of the range.
+ * @param end One past the last element of the range.
+ */
+void AirportTree::split(std::size_t begin, std::size_t end)
+{
+    if (end - begin <= 1)
+    {
+        return;
+    }
+
+    std::uint8_t axis = 0;
+    double widest = -1;
+    for (std::uint8_t candidate = 0; candidate < 3; candidate++)
+    {
+        auto bounds = std::minmax_element(Points.begin() + begin, Points.begin() + end, [candidate](const TreePoint &a, const TreePoint &b)
+                                          { return a.Coordinates[candidate] < b.Coordinates[candidate]; });
+        double width = bounds.second->Coordinates[candidate] - bounds.first->Coordinates[candidate];
+        if (width > widest)
+        {
+            widest = width;
+            axis = candidate;
+        }
+    }
+
+    std::size_t middle = begin + (end - begin) / 2;
+    std::nth_element(Points.begin() + begin, Points.begin() + middle, Points.begin() + end, [axis](const TreePoint &a, const TreePoint &b)
+                     { return a.Coordinates[axis] < b.Coordinates[axis]; });
+    Axes[middle] = axis;
+    split(begin, middle);
+    split(middle + 1, end);
+}
+
+/**
+ * @brief Collects the points of one range closer than a limit to a query point.
+ * A half is only visited if the splitting plane is within the limit.
+ *
+ * @param query The query point.
+ * @param begin The first element of the range.
+ * @param end One past the last element of the range.
+ * @param limit The largest squared straight-line distance to collect.
+ * @param found Receives the tree index and squared distance of every point collected.
+ */
+void AirportTree::collect(const TreePoint &query, std::size_t begin, std::size_t end, double limit, std::vector<std::pair<double, std::size_t>> &found) const
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    std::size_t middle = begin + (end - begin) / 2;
+    const TreePoint &point = Points[middle];
+    double distance = squaredDistance(query.Coordinates, point.Coordinates);
+    if (distance <= limit)
+    {
+        found.emplace_back(distance, middle);
+    }
+
+    double offset = query.Coordinates[Axes[middle]] - point.Coordinates[Axes[middle]];
+    if (offset <= 0 || offset * offset <= limit)
+    {
+        collect(query, begin, middle, limit, found);
+    }
+    if (offset >= 0 || offset * offset <= limit)
+    {
+        collect(query, middle + 1, end, limit, found);
+    }
+}
+
+/**
+ * @brief Keeps the k points of one range closest to a query point.
+ * The half containing the query point is visited first, so the far half can usually be skipped.
+ *
+ * @param query The query point.
+ * @param begin The first element of the range.
+ * @param end One past the last element of the range.
+ * @param k The number of points to keep.
+ * @param best A max-heap of the squared distance and tree index of the closest points found so far.
+ */
+void AirportTree::closest(const TreePoint &query, std::size_t begin, std::size_t end, std::size_t k, std::vector<std::pair<double, std::size_t>> &best) const
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    std::size_t middle = begin + (end - begin) / 2;
+    const TreePoint &point = Points[middle];
+    double distance = squaredDistance(query.Coordinates, point.Coordinates);
+    if (best.size() < k)
+    {
+        best.emplace_back(distance, middle);
+        std::push_heap(best.begin(), best.end());
+    }
+    else if (distance < best.front().first)
+    {
+        std::pop_heap(best.begin(), best.end());
+        best.back() = std::make_pair(distance, middle);
+        std::push_heap(best.begin(), best.end());
+    }
+
+    double offset = query.Coordinates[Axes[middle]] - point.Coordinates[Axes[middle]];
+    bool left = offset < 0;
+    closest(query, left ? begin : middle + 1, left ? middle : end, k, best);
+    if (best.size() < k || offset * offset < best.front().first)
+    {
+        closest(query, left ? middle + 1 : begin, left ? end : middle, k, best);
+    }
+}
+
+/**
+ * @brief Turns squared straight-line distances into great-circle distances, closest first.
+ *
+ * @param found The squared distance and tree index of every point.
+ * @return The airports, sorted by distance.
+ */
+std::vector<NearbyAirport> AirportTree::toNearby(std::vector<std::pair<double, std::size_t>> &found) const
+{
+    std::sort(found.begin(), found.end());
+    std::vector<NearbyAirport> nearby;
+    nearby.reserve(found.size());
+    for (auto const &entry : found)
+    {
+        // a chord of length c spans an angle of 2 asin(c / 2)
+        double chord = std::min(2.0, sqrt(entry.first));
+        nearby.push_back(NearbyAirport{Points[entry.second].Id, 2 * EarthRadius * asin(chord / 2)});
+    }
+    return nearby;
+}
+
+/**
+ * @brief Finds the airports closest to a position.
+ *
+ * @param lat The latitude of the position in degrees.
+ * @param lon The longitude of the position in degrees.
+ * @param k The number of airports to find.
+ * @return The k airports closest to the position, or every airport if there are fewer, closest first.
+ */
+std::vector<NearbyAirport> AirportTree::nearest(double lat, double lon, std::size_t k) const
+{
+    std::vector<std::pair<double, std::size_t>> best;
+    if (k == 0 || std::isnan(lat) || std::isnan(lon))
+    {
+        return toNearby(best);
+    }
+    best.reserve(std::min(k, Points.size()));
+    closest(toPoint(lat, lon, 0), 0, Points.size(), k, best);
+    return toNearby(best);
+}
+
+/**
+ * @brief Finds the airports within a distance of a position.
+ *
+ * @param lat The latitude of the position in degrees.
+ * @param lon The longitude of the position in degrees.
+ * @param radius The largest great-circle distance in kilometers.
+ * @return The airports within the distance of the position, closest first.
+ */
+std::vector<NearbyAirport> AirportTree::within(double lat, double lon, double radius) const
+{
+    std::vector<std::pair<double, std::size_t>> found;
+    if (!(radius >= 0) || std::isnan(lat) || std::isnan(lon))
+    {
+        return toNearby(found);
+    }
+
+    // the straight-line distance matching the radius, with a little slack so rounding cannot drop airports on the edge
+    double angle = std::min(M_PI, radius / EarthRadius);
+    double chord = 2 * sin(angle / 2);
+    collect(toPoint(lat, lon, 0), 0, Points.size(), chord * chord * (1 + 1e-12), found);
+
+    std::vector<NearbyAirport> nearby = toNearby(found);
+    while (!nearby.empty() && nearby.back().Distance > radius)
+    {
+        nearby.pop_back();
+    }
+    return nearby;
+}
+
+/**
+ * @brief Gets the number of airports in the tree.
+ *
+ * @return The number of airports with a position.
+ */
+std::size_t AirportTree::size() const
+{
+    return Points.size();
+}
@@ -0,0 +1,141 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef AIRPORT_TREE_H
+#define AIRPORT_TREE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @struct NearbyAirport
+ * @brief An airport found by a spatial query, with its great-circle distance from the query point.
+ */
+struct NearbyAirport
+{
+    std::uint32_t Id; /**< The id of the airport. */
+    double Distance;  /**< The great-circle distance from the query point in kilometers. */
+};
+
+/**
+ * @class AirportTree
+ * @brief A k-d tree over airport positions, answering nearest-airport and radius queries in logarithmic time.
+ *
+ * Every position is stored as a point on the unit sphere in three dimensions, where the straight-line distance
+ * between two points grows with their great-circle distance. Queries therefore need no special care for the date
+ * line or the poles. The tree is implicit: the points are ordered so that every range of the arrays is split at its
+ * middle element, with the lower coordinates on the left, and the split axis of every element is stored alongside it.
+ */
+class AirportTree
+{
+
+private:
+    /**
+     * @struct TreePoint
+     * @brief An airport and its position on the unit sphere.
+     */
+    struct TreePoint
+    {
+        double Coordinates[3]; /**< The x, y and z coordinates of the point. */
+        std::uint32_t Id; /**< The id of the airport. */
+    };
+
+    std::vector<TreePoint> Points; /**< The position of every airport, in tree order. */
+    std::vector<std::uint8_t> Axes; /**< The axis each element splits its range on, in tree order. */
+
+    /**
+     * @brief Converts a position in degrees to a point on the unit sphere.
+     *
+     * @param lat The latitude in degrees.
+     * @param lon The longitude in degrees.
+     * @param id The id of the airport at the position.
+     * @return The point.
+     */
+    static TreePoint toPoint(double lat, double lon, std::uint32_t id);
+
+    /**
+     * @brief Orders one range of the tree arrays around its middle element, then orders both halves.
+     *
+     * @param begin The first element of the range.
+     * @param end One past the last element of the range.
+     */
+    void split(std::size_t begin, std::size_t end);
+
+    /**
+     * @brief Collects the points of one range closer than a limit to a query point.
+     *
+     * @param query The query point.
+     * @param begin The first element of the range.
+     * @param end One past the last element of the range.
+     * @param limit The largest squared straight-line distance to collect.
+     * @param found Receives the tree index and squared distance of every point collected.
+     */
+    void collect(const TreePoint &query, std::size_t begin, std::size_t end, double limit, std::vector<std::pair<double, std::size_t>> &found) const;
+
+    /**
+     * @brief Keeps the k points of one range closest to a query point.
+     *
+     * @param query The query point.
+     * @param begin The first element of the range.
+     * @param end One past the last element of the range.
+     * @param k The number of points to keep.
+     * @param best A max-heap of the squared distance and tree index of the closest points found so far.
+     */
+    void closest(const TreePoint &query, std::size_t begin, std::size_t end, std::size_t k, std::vector<std::pair<double, std::size_t>> &best) const;
+
+    /**
+     * @brief Turns squared straight-line distances into great-circle distances, closest first.
+     *
+     * @param found The squared distance and tree index of every point.
+     * @return The airports, sorted by distance.
+     */
+    std::vector<NearbyAirport> toNearby(std::vector<std::pair<double, std::size_t>> &found) const;
+
+public:
+    /**
+     * @brief Default constructor for the AirportTree class.
+     * Creates an empty tree.
+     */
+    AirportTree();
+
+    /**
+     * @brief Builds a tree over the positions of a set of airports.
+     * Airports with a NaN coordinate have no position and are left out.
+     *
+     * @param ids The ids of the airports.
+     * @param latitudes The latitude of every airport in degrees, parallel to ids.
+     * @param longitudes The longitude of every airport in degrees, parallel to ids.
+     * @return The tree.
+     */
+    static AirportTree build(const std::vector<std::uint32_t> &ids, const std::vector<double> &latitudes, const std::vector<double> &longitudes);
+
+    /**
+     * @brief Finds the airports closest to a position.
+     *
+     * @param lat The latitude of the position in degrees.
+     * @param lon The longitude of the position in degrees.
+     * @param k The number of airports to find.
+     * @return The k airports closest to the position, or every airport if there are fewer, closest first.
+     */
+    std::vector<NearbyAirport> nearest(double lat, double lon, std::size_t k) const;
+
+    /**
+     * @brief Finds the airports within a distance of a position.
+     *
+     * @param lat The latitude of the position in degrees.
+     * @param lon The longitude of the position in degrees.
+     * @param radius The largest great-circle distance in kilometers.
+     * @return The airports within the distance of the position, closest first.
+     */
+    std::vector<NearbyAirport> within(double lat, double lon, double radius) const;
+
+    /**
+     * @brief Gets the number of airports in the tree.
+     *
+     * @return The number of airports with a position.
+     */
+    std::size_t size() const;
+};
+
+#endif // AIRPORT_TREE_H
@@ -0,0 +1,107 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include "thread_pool.h"
+
+/**
+ * @brief Starts the worker threads.
+ *
+ * @param threads The number of worker threads, or 0 to use every hardware thread.
+ */
+ThreadPool::ThreadPool(unsigned threads)
+{
+    this->Running = 0;
+    this->Stopping = false;
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; i++)
+    {
+        Workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+/**
+ * @brief Finishes the queued tasks and stops the worker threads.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Stopping = true;
+    }
+    TaskReady.notify_all();
+    for (auto &worker : Workers)
+    {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Runs queued tasks until the pool is stopped.
+ * Workers only exit once the queue is empty, so tasks submitted before destruction still run.
+ */
+void ThreadPool::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+    while (true)
+    {
+        TaskReady.wait(lock, [this]() { return Stopping || !Tasks.empty(); });
+        if (Tasks.empty())
+        {
+            return;
+        }
+        std::function<void()> task = std::move(Tasks.front());
+        Tasks.pop_front();
+        Running++;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        Running--;
+        if (Running == 0 && Tasks.empty())
+        {
+            AllDone.notify_all();
+        }
+    }
+}
+
+/**
+ * @brief Queues a task to be run by one of the worker threads.
+ *
+ * @param task The task to run.
+ */
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Tasks.push_back(std::move(task));
+    }
+    TaskReady.notify_one();
+}
+
+/**
+ * @brief Waits until every submitted task has finished.
+ */
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+    AllDone.wait(lock, [this]() { return Running == 0 && Tasks.empty(); });
+}
+
+/**
+ * @brief Gets the number of worker threads.
+ *
+ * @return The number of worker threads.
+ */
+std::size_t ThreadPool::size() const
+{
+    return Workers.size();
+}
@@ -0,0 +1,74 @@
+//  Created by Omar Basheer on 10/18/26.
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <condition_variable>
+
+/**
+ * @class ThreadPool
+ * @brief A fixed set of worker threads that run submitted tasks.
+ *
+ * Tasks are taken from a shared queue in submission order. The threads are started once and reused for every task,
+ * so many small jobs, such as one route search per query of a batch, do not each pay for starting a thread.
+ */
+class ThreadPool
+{
+
+private:
+    std::vector<std::thread> Workers; /**< The worker threads. */
+    std::deque<std::function<void()>> Tasks; /**< The tasks waiting for a worker. */
+    std::mutex Mutex; /**< Guards Tasks, Running and Stopping. */
+    std::condition_variable TaskReady; /**< Signalled when a task is queued or the pool is stopping. */
+    std::condition_variable AllDone; /**< Signalled when the last running task finishes with nothing queued. */
+    std::size_t Running; /**< The number of tasks being run. */
+    bool Stopping; /**< Set when the pool is being destroyed. */
+
+    /**
+     * @brief Runs queued tasks until the pool is stopped.
+     */
+    void workerLoop();
+
+public:
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param threads The number of worker threads, or 0 to use every hardware thread.
+     */
+    explicit ThreadPool(unsigned threads = 0);
+
+    /**
+     * @brief Finishes the queued tasks and stops the worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Queues a task to be run by one of the worker threads.
+     *
+     * @param task The task to run.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Waits until every submitted task has finished.
+     */
+    void wait();
+
+    /**
+     * @brief Gets the number of worker threads.
+     *
+     * @return The number of worker threads.
+     */
+    std::size_t size() const;
+};
+
+#endif // THREAD_POOL_H